@@ -14,6 +14,13 @@
 #include <system_error>
 #include <variant>
 #include <memory>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+#include <memory_resource>
 
 #include "ed25519/c++17/variant.hpp"
 
@@ -25,6 +32,8 @@ namespace ed25519 {
 
     /**
     * Common error handling closure.
+    * The category of the error code lives only during the call: read code.message() in the handler,
+    * keep the message string instead of the error code when it is needed later.
     * */
     typedef std::function<void(const std::error_code &code)> ErrorHandler;
 
@@ -33,6 +42,37 @@ namespace ed25519 {
      */
     static auto default_error_handler = [](const std::error_code &code) {UNUSED(code);};
 
+    /**
+     * Memory resource support covers the per-request path: Pair::sign(..., resource),
+     * Data::encode(resource), Data::to_hex(resource) and the non-allocating TryDecode, verify and
+     * Digest(handler). Verifier, Digest::Bulk, ParallelHash, Blake3, Pair::Generate, PreparedPeer::Prepare,
+     * PreparedParent::derive and the base58 bulk codec allocate from the global heap: they allocate
+     * and free on worker threads, where a std::pmr::monotonic_buffer_resource is not safe to use.
+     */
+    namespace pmr {
+
+        /**
+         * Deleter of an object constructed in a memory resource
+         * @tparam T - object type
+         */
+        template<typename T>
+        struct deleter {
+            std::pmr::memory_resource *resource;
+
+            void operator()(T *object) const {
+              object->~T();
+              resource->deallocate(object, sizeof(T), alignof(T));
+            }
+        };
+
+        /**
+         * Object owned in a memory resource, e.g. in a per-request std::pmr::monotonic_buffer_resource
+         * @tparam T - object type
+         */
+        template<typename T>
+        using unique_ptr = std::unique_ptr<T, deleter<T>>;
+    }
+
     /**
      * Base58 string to/from encoding/decoding
      * */
@@ -45,10 +85,29 @@ namespace ed25519 {
         constexpr const size_t digest      = hash;
         constexpr const size_t seed        = hash;
 
+        constexpr const size_t exchange_key  = hash;
+        constexpr const size_t shared_secret = hash;
+        constexpr const size_t tweak         = hash;
+
         constexpr const size_t private_key = double_hash;
         constexpr const size_t signature   = double_hash;
     }
 
+    /**
+     * Plain records of a public key, a signature and a digest: trivially copyable, without the vtable
+     * of Data, so arrays of them are contiguous 32 or 64-byte records that may be memcpy'd or mapped
+     */
+    struct PublicKeyBytes: std::array<unsigned char, size::public_key> {};
+    struct SignatureBytes: std::array<unsigned char, size::signature> {};
+    struct DigestBytes: std::array<unsigned char, size::digest> {};
+
+    static_assert(std::is_trivially_copyable_v<PublicKeyBytes> && sizeof(PublicKeyBytes) == size::public_key,
+                  "PublicKeyBytes is a plain 32-byte record");
+    static_assert(std::is_trivially_copyable_v<SignatureBytes> && sizeof(SignatureBytes) == size::signature,
+                  "SignatureBytes is a plain 64-byte record");
+    static_assert(std::is_trivially_copyable_v<DigestBytes> && sizeof(DigestBytes) == size::digest,
+                  "DigestBytes is a plain 32-byte record");
+
     enum error:int {
         BADFORMAT = 1000,
         UNEXPECTED_SIZE = 1001,
@@ -67,9 +126,70 @@ namespace ed25519 {
         std::string mess_;
     };
 
+    /**
+     * Reason of a failed decoding, the message is built only when it is asked for
+     */
+    struct decode_error {
+        error code;
+
+        /** decoded payload size of UNEXPECTED_SIZE, SIZE_MAX if the payload does not fit the decoder */
+        size_t size;
+
+        /** expected payload size */
+        size_t expected_size;
+
+        /**
+         * Error message, the same as of the error_code passed to an ErrorHandler
+         * @return message
+         */
+        std::string message() const;
+    };
+
+    /**
+     * Value or reason of a failure, like std::expected<T, decode_error>
+     * @tparam T - decoded type
+     */
+    template<typename T>
+    class expected {
+    public:
+        expected(const T &value): value_(value), error_{} {}
+        expected(const decode_error &error): value_(std::nullopt), error_(error) {}
+
+        bool has_value() const noexcept { return value_.has_value(); }
+        explicit operator bool() const noexcept { return has_value(); }
+
+        const T &value() const { return value_.value(); }
+        T &value() { return value_.value(); }
+
+        const T &operator*() const { return *value_; }
+        T &operator*() { return *value_; }
+        const T *operator->() const { return &*value_; }
+        T *operator->() { return &*value_; }
+
+        /**
+         * Reason of the failure, undefined if there is a value
+         */
+        const decode_error &error() const noexcept { return error_; }
+
+        /**
+         * Error message of the failure, built on demand
+         */
+        std::string message() const { return error_.message(); }
+
+    private:
+        std::optional<T> value_;
+        decode_error error_;
+    };
+
     namespace base58 {
 
-        uint_least32_t crc32(unsigned char *buf, size_t len);
+        /**
+         * CRC-32 (IEEE, the zlib crc32) of the 4-byte base58 checksum
+         * @param buf - data
+         * @param len - data size
+         * @return crc
+         */
+        uint_least32_t crc32(const unsigned char *buf, size_t len);
 
         /**
          * Encode binary data to base58 string
@@ -87,12 +207,110 @@ namespace ed25519 {
         bool decode(const std::string& str, std::vector<unsigned char>& data);
 
         /**
-         * Validate base58-encoded string
+         * Validate base58-encoded string of any payload size,
+         * strings shorter than 256 characters are decoded on the stack
          * @param str encoded string
          * @return false if decoding is failed
          */
         bool validate(const std::string &str);
 
+        /**
+         * Upper bound of the base58 string length of N payload bytes with 4-byte checksum
+         */
+        template<size_t N>
+        constexpr size_t max_encoded_size = (N + 4) * 138 / 100 + 1;
+
+        /**
+         * Fixed-capacity null-terminated string living on the stack
+         * @tparam Capacity - maximal number of characters
+         */
+        template<size_t Capacity>
+        class fixed_string {
+        public:
+            static constexpr size_t capacity = Capacity;
+
+            fixed_string():data_{}, size_(0) {}
+
+            const char *data() const { return data_.data(); }
+            char *data() { return data_.data(); }
+            const char *c_str() const { return data_.data(); }
+            size_t size() const { return size_; }
+            bool empty() const { return size_ == 0; }
+
+            const char *begin() const { return data_.data(); }
+            const char *end() const { return data_.data() + size_; }
+
+            /**
+             * Set the length, characters are written through data()
+             * @param size - number of characters, not greater than capacity
+             */
+            void resize(size_t size) {
+              size_ = std::min(size, Capacity);
+              data_[size_] = '\0';
+            }
+
+            std::string str() const { return std::string(data(), size()); }
+
+            operator std::string_view() const { return std::string_view(data(), size()); }
+
+            bool operator==(std::string_view other) const { return std::string_view(*this) == other; }
+            bool operator!=(std::string_view other) const { return !(*this == other); }
+
+        private:
+            std::array<char, Capacity + 1> data_;
+            size_t size_;
+        };
+
+        /**
+         * Encode binary data with 4-byte checksum to base58 without heap allocations.
+         * Result is equal to encode(data).
+         * @tparam N - size of data
+         * @param data - data
+         * @return base58-encoded string
+         */
+        template<size_t N>
+        fixed_string<max_encoded_size<N>> encode_fixed(const std::array<unsigned char, N> &data);
+
+        /**
+         * Decode base58 string with 4-byte checksum of exactly N payload bytes without heap allocations
+         * @tparam N - size of data
+         * @param str - encoded string
+         * @param data - decoded data, it is not changed when decoding is failed
+         * @return false if decoding is failed or the payload is not N bytes long
+         */
+        template<size_t N>
+        bool decode_fixed(std::string_view str, std::array<unsigned char, N> &data);
+
+        /**
+         * Decode base58 string with 4-byte checksum of exactly size payload bytes.
+         * Nothing is allocated, the failure is classified on the stack: strings decoding to more than
+         * 256 bytes are reported as UNEXPECTED_SIZE without checking their checksum.
+         * @param str - encoded string
+         * @param data - decoded data of size bytes, it is not changed when decoding is failed
+         * @param size - expected payload size
+         * @param failure - reason of the failure
+         * @return false if decoding is failed
+         */
+        bool try_decode(std::string_view str, unsigned char *data, size_t size, decode_error &failure) noexcept;
+
+        /**
+         * Keys, digests and signatures: the conversion runs on 58^5 limbs in stack arrays
+         * with precomputed powers instead of byte-at-a-time bignum arithmetic
+         */
+        template<>
+        fixed_string<max_encoded_size<size::hash>> encode_fixed<size::hash>(
+                const std::array<unsigned char, size::hash> &data);
+
+        template<>
+        fixed_string<max_encoded_size<size::double_hash>> encode_fixed<size::double_hash>(
+                const std::array<unsigned char, size::double_hash> &data);
+
+        template<>
+        bool decode_fixed<size::hash>(std::string_view str, std::array<unsigned char, size::hash> &data);
+
+        template<>
+        bool decode_fixed<size::double_hash>(std::string_view str, std::array<unsigned char, size::double_hash> &data);
+
         /**
          * Decode base58 string to binary format
          * @param base58 -encoded string
@@ -105,11 +323,19 @@ namespace ed25519 {
                 std::array<unsigned char, N> &data,
                 const ErrorHandler &error = default_error_handler){
 
+          if constexpr (N == size::hash || N == size::double_hash) {
+            if (decode_fixed(base58, data))
+              return true;
+          }
+
+          // errors are reported by the generic decoder
+
           std::vector<unsigned char> v;
 
-          if (!decode(base58.c_str(), v))
+          if (!decode(base58, v))
           {
-            std::error_code ec(static_cast<int>(error::BADFORMAT),error_category());
+            error_category category;
+            std::error_code ec(static_cast<int>(error::BADFORMAT),category);
             error(ec);
 
             return false;
@@ -119,7 +345,8 @@ namespace ed25519 {
           {
             std::stringstream errorMessage;
             errorMessage << "size of decoded vector is not equal to expected size: " << v.size() << " <> " << N;
-            std::error_code ec(static_cast<int>(error::UNEXPECTED_SIZE),error_category(errorMessage.str()));
+            error_category category(errorMessage.str());
+            std::error_code ec(static_cast<int>(error::UNEXPECTED_SIZE),category);
             error(ec);
 
             return false;
@@ -140,6 +367,10 @@ namespace ed25519 {
         std::string encode(
                 const std::array<unsigned char, N> &data) {
 
+          if constexpr (N == size::hash || N == size::double_hash) {
+            return encode_fixed(data).str();
+          }
+
           // add 4-byte hash check to the end
 
           std::vector<unsigned char> vch;
@@ -155,6 +386,290 @@ namespace ed25519 {
 
           return encode(vch);
         }
+
+        template<size_t N>
+        fixed_string<max_encoded_size<N>> encode_fixed(const std::array<unsigned char, N> &data) {
+          auto encoded = encode(data);
+          fixed_string<max_encoded_size<N>> result;
+          std::copy_n(encoded.begin(), std::min(encoded.size(), result.capacity), result.data());
+          result.resize(encoded.size());
+          return result;
+        }
+
+        template<size_t N>
+        bool decode_fixed(std::string_view str, std::array<unsigned char, N> &data) {
+          std::vector<unsigned char> v;
+          if (!decode(std::string(str), v) || v.size() != N)
+            return false;
+          std::copy_n(v.begin(), N, data.begin());
+          return true;
+        }
+
+        /**
+         * Validate base58-encoded string of exactly N payload bytes with checksum.
+         * Keys, digests and signatures are decoded into a stack buffer, nothing is allocated.
+         * @tparam N - expected payload size
+         * @param str encoded string
+         * @return false if decoding is failed or the payload is not N bytes long
+         */
+        template<size_t N>
+        bool validate(std::string_view str) {
+          std::array<unsigned char, N> data;
+          return decode_fixed(str, data);
+        }
+
+        /**
+         * CRC-32 of the base58 checksum, usable in constant expressions
+         */
+        constexpr uint_least32_t crc32_constexpr(const unsigned char *buf, size_t len) {
+          uint_least32_t crc = 0xffffffff;
+          for (size_t i = 0; i < len; ++i) {
+            crc ^= buf[i];
+            for (int k = 0; k < 8; ++k)
+              crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+          }
+          return ~crc & 0xffffffff;
+        }
+
+        /**
+         * Decode base58 string with 4-byte checksum of exactly N payload bytes in a constant expression.
+         * A malformed string throws std::invalid_argument: when the result initializes a constexpr
+         * variable, it is a compilation error.
+         * @tparam N - size of data
+         * @param str - encoded string, leading and trailing spaces are skipped as by decode()
+         * @return decoded data
+         */
+        template<size_t N>
+        constexpr std::array<unsigned char, N> decode_constexpr(std::string_view str) {
+
+          size_t first = 0, last = str.size();
+          while (first < last && (str[first] == ' ' || (str[first] >= '\t' && str[first] <= '\r'))) ++first;
+          while (last > first && (str[last - 1] == ' ' || (str[last - 1] >= '\t' && str[last - 1] <= '\r'))) --last;
+
+          constexpr std::string_view alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+          size_t zeroes = 0;
+          while (first + zeroes < last && str[first + zeroes] == '1') ++zeroes;
+
+          // big-endian number of N + 4 bytes, a longer one does not fit
+          std::array<unsigned char, N + 4> bytes{};
+          for (size_t i = first; i < last; ++i) {
+            auto digit = alphabet.find(str[i]);
+            if (digit == std::string_view::npos)
+              throw std::invalid_argument("base58: invalid character");
+            unsigned carry = static_cast<unsigned>(digit);
+            for (size_t k = N + 4; k-- > 0; ) {
+              carry += 58u * bytes[k];
+              bytes[k] = static_cast<unsigned char>(carry & 0xff);
+              carry >>= 8;
+            }
+            if (carry != 0)
+              throw std::invalid_argument("base58: unexpected data size");
+          }
+
+          // every leading '1' is one leading zero byte
+          size_t leading = 0;
+          while (leading < N + 4 && bytes[leading] == 0) ++leading;
+          if (leading != zeroes)
+            throw std::invalid_argument("base58: unexpected data size");
+
+          auto crc = crc32_constexpr(bytes.data(), N);
+          for (size_t k = 0; k < 4; ++k)
+            if (bytes[N + k] != static_cast<unsigned char>((crc >> (8 * k)) & 0xff))
+              throw std::invalid_argument("base58: checksum mismatch");
+
+          std::array<unsigned char, N> data{};
+          for (size_t k = 0; k < N; ++k) data[k] = bytes[k];
+          return data;
+        }
+
+        /**
+         * Base58 strings of many items in one buffer, every string is followed by '\n'
+         */
+        struct encoded_list {
+            std::string buffer;
+
+            /** string i is buffer[offsets[i], offsets[i + 1] - 1), there are size() + 1 offsets */
+            std::vector<size_t> offsets;
+
+            size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+            std::string_view operator[](size_t i) const {
+              return std::string_view(buffer).substr(offsets[i], offsets[i + 1] - offsets[i] - 1);
+            }
+        };
+
+        /**
+         * Size of the fixed-size data an item derives from
+         */
+        template<size_t N>
+        std::integral_constant<size_t, N> array_size_of(const std::array<unsigned char, N> *);
+
+        /**
+         * Encode count items of size bytes with checksum into one buffer, on several threads
+         * @param first - first item bytes, item i starts at first + i * stride
+         * @param stride - distance between items
+         * @param count - number of items
+         * @param size - item size
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @return strings of the items in order
+         */
+        encoded_list encode_bulk(const unsigned char *first, size_t stride, size_t count, size_t size,
+                                 size_t threads = 0);
+
+        /**
+         * Encode keys, digests, signatures or other Data<N> into one newline-separated buffer
+         * @param items - items
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @return strings of the items in order
+         */
+        template<typename T>
+        encoded_list encode_bulk(const std::vector<T> &items, size_t threads = 0) {
+          constexpr size_t N = decltype(array_size_of(static_cast<const T *>(nullptr)))::value;
+          return encode_bulk(items.empty() ? nullptr : items.front().data(), sizeof(T), items.size(), N, threads);
+        }
+
+        /**
+         * Number of lines in a newline-separated text, a final '\n' does not start a new line
+         */
+        size_t count_lines(std::string_view text);
+
+        /**
+         * Decode count_lines(text) newline-separated strings of size-byte payloads, on several threads
+         * @param text - strings, a line may end with "\r\n"
+         * @param size - payload size of every string
+         * @param data - count * size bytes
+         * @param count - count_lines(text), another count is reported as UNEXPECTED_SIZE
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @param error - reports the first line failed to decode
+         * @return false if count is wrong or any line is failed to decode
+         */
+        bool decode_bulk(std::string_view text, size_t size, unsigned char *data, size_t count,
+                         size_t threads = 0, const ErrorHandler &error = default_error_handler);
+
+        /**
+         * Decode newline-separated strings into a flat array
+         * @tparam N - payload size of every string
+         * @param text - strings
+         * @param data - decoded items in line order, empty if decoding is failed
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @param error - reports the first line failed to decode
+         * @return false if any line is failed to decode
+         */
+        template<size_t N>
+        bool decode_bulk(std::string_view text, std::vector<std::array<unsigned char, N>> &data,
+                         size_t threads = 0, const ErrorHandler &error = default_error_handler) {
+          static_assert(sizeof(std::array<unsigned char, N>) == N, "items must be packed");
+          data.resize(count_lines(text));
+          if (!decode_bulk(text, N, data.empty() ? nullptr : data.front().data(), data.size(), threads, error)) {
+            data.clear();
+            return false;
+          }
+          return true;
+        }
+
+        /**
+         * Stream newline-separated strings of count items to a file descriptor, block by block
+         * @param fd - file descriptor
+         * @param first - first item bytes, item i starts at first + i * stride
+         * @param stride - distance between items
+         * @param count - number of items
+         * @param size - item size
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @param error - reports errno of a failed write
+         * @return false if writing is failed
+         */
+        bool write_bulk(int fd, const unsigned char *first, size_t stride, size_t count, size_t size,
+                        size_t threads = 0, const ErrorHandler &error = default_error_handler);
+
+        template<typename T>
+        bool write_bulk(int fd, const std::vector<T> &items,
+                        size_t threads = 0, const ErrorHandler &error = default_error_handler) {
+          constexpr size_t N = decltype(array_size_of(static_cast<const T *>(nullptr)))::value;
+          return write_bulk(fd, items.empty() ? nullptr : items.front().data(), sizeof(T), items.size(), N,
+                            threads, error);
+        }
+
+        /**
+         * Read newline-separated strings from a file descriptor until the end of file, block by block
+         * @param fd - file descriptor
+         * @param size - payload size of every string
+         * @param handler - receives every decoded block: count items of size bytes
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @param error - reports errno of a failed read or the first line failed to decode
+         * @return false if reading or decoding is failed
+         */
+        bool read_bulk(int fd, size_t size, const std::function<void(const unsigned char *items, size_t count)> &handler,
+                       size_t threads = 0, const ErrorHandler &error = default_error_handler);
+
+        template<size_t N>
+        bool read_bulk(int fd, std::vector<std::array<unsigned char, N>> &data,
+                       size_t threads = 0, const ErrorHandler &error = default_error_handler) {
+          return read_bulk(fd, N, [&data](const unsigned char *items, size_t count) {
+              for (size_t i = 0; i < count; ++i, items += N)
+                std::copy_n(items, N, data.emplace_back().begin());
+          }, threads, error);
+        }
+    }
+
+    namespace literals {
+
+        /**
+         * Public key bytes of a base58 literal, decoded at compile time:
+         * constexpr auto root = "..."_pubkey; keys::Public key(root);
+         * A malformed literal fails compilation of a constexpr variable.
+         */
+        constexpr std::array<unsigned char, size::public_key> operator "" _pubkey(const char *str, size_t len) {
+          return base58::decode_constexpr<size::public_key>(std::string_view(str, len));
+        }
+    }
+
+    /**
+     * Hex string to/from encoding/decoding
+     * */
+    namespace hex {
+
+        /**
+         * Encode binary data to lowercase hex
+         * @param data - data
+         * @param size - size of data
+         * @param out - receives 2 * size characters
+         */
+        void encode(const unsigned char *data, size_t size, char *out);
+
+        /**
+         * Encode binary data to lowercase hex string
+         * @param data - data
+         * @param size - size of data
+         * @return hex string
+         */
+        std::string encode(const unsigned char *data, size_t size);
+
+        template<size_t N>
+        std::string encode(const std::array<unsigned char, N> &data) {
+          return encode(data.data(), N);
+        }
+
+        /**
+         * Decode hex string of either case to exactly size bytes
+         * @param str - hex string
+         * @param data - decoded data
+         * @param size - expected size of data
+         * @param error - error handler
+         * @return false if the string length is not 2 * size or it has non-hex characters
+         */
+        bool decode(std::string_view str, unsigned char *data, size_t size,
+                    const ErrorHandler &error = default_error_handler);
+
+        template<size_t N>
+        bool decode(std::string_view str, std::array<unsigned char, N> &data,
+                    const ErrorHandler &error = default_error_handler) {
+          std::array<unsigned char, N> bytes;
+          if (!decode(str, bytes.data(), N, error))
+            return false;
+          data = bytes;
+          return true;
+        }
     }
 
     /**
@@ -220,6 +735,19 @@ namespace ed25519 {
           return std::nullopt;
         }
 
+        /**
+        * Restore data from base58-encoded string without allocations
+        * @param base58 encoded data
+        * @return data or the reason of the failure
+        */
+        inline static expected<Data<N>> TryDecode(std::string_view base58) {
+          auto s = Data<N>();
+          decode_error failure{};
+          if (base58::try_decode(base58, s.data(), N, failure))
+            return s;
+          return failure;
+        }
+
         Data():binary_data() { clean(); }
 
         /**
@@ -235,6 +763,24 @@ namespace ed25519 {
           return base58::encode(*this);
         }
 
+        /**
+         * Encode from binary to base58 encoded string in a memory resource
+         * @param resource - memory resource of the string
+         * @return encoded string, equal to encode()
+         */
+        [[nodiscard]] std::pmr::string encode(std::pmr::memory_resource *resource) const {
+          auto encoded = encode_fixed();
+          return std::pmr::string(encoded.data(), encoded.size(), resource);
+        }
+
+        /**
+         * Encode from binary to base58 encoded string on the stack
+         * @return encoded string, equal to encode()
+         */
+        [[nodiscard]] base58::fixed_string<base58::max_encoded_size<N>> encode_fixed() const {
+          return base58::encode_fixed(*this);
+        }
+
         /**
          * Decode base58 encoded string to binary represenation
          * @param base58 encoded string
@@ -245,26 +791,51 @@ namespace ed25519 {
           return base58::decode(base58, *this, error);
         }
 
-        bool validate() const override {
-          if (N == this->size()) {
+        /**
+         * Encode from binary to lowercase hex string
+         * @return hex string
+         */
+        [[nodiscard]] std::string to_hex() const {
+          return hex::encode(*this);
+        }
 
-            if (encode().empty())
-              return  false;
+        /**
+         * Encode from binary to lowercase hex string in a memory resource
+         * @param resource - memory resource of the string
+         * @return hex string
+         */
+        [[nodiscard]] std::pmr::string to_hex(std::pmr::memory_resource *resource) const {
+          std::pmr::string str(2 * N, '\0', resource);
+          hex::encode(binary_data::data(), N, str.data());
+          return str;
+        }
 
-            return base58::validate(encode());
-          }
-          else {
-            return false;
-          }
+        /**
+         * Decode hex string of either case to binary represenation
+         * @param hex string
+         * @param error - error handler
+         * @return false if decoding is failed, data is not changed then
+         */
+        bool from_hex(std::string_view hex, const ErrorHandler &error = default_error_handler) {
+          return hex::decode(hex, *this, error);
+        }
+
+        /**
+         * Validate binary data in place, no string work. Any N bytes are valid data,
+         * keys and signatures check their contents.
+         * @return true if the data has N bytes
+         */
+        bool validate() const override {
+          return N == this->size();
         }
 
         /**
          * Validate string before create encoded data.
          * @param string base58-encoded string
-         * @return validation result
+         * @return true if the string decodes to exactly N bytes
          */
         static bool validate(const std::string &string) {
-          return base58::validate(string);
+          return base58::validate<N>(string);
         }
     };
 
@@ -278,6 +849,9 @@ namespace ed25519 {
         bool decode(const std::string &base58, const ErrorHandler &error = default_error_handler) override {
           return Data<N>::decode(base58, error);
         }
+        bool from_hex(std::string_view hex, const ErrorHandler &error = default_error_handler) {
+          return Data<N>::from_hex(hex, error);
+        }
         friend class keys::Pair;
     };
 
@@ -294,6 +868,15 @@ namespace ed25519 {
                 big = 1
             };
 
+            /**
+             * Default endianness of a new calculator
+             */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            static constexpr endian host_endian = big;
+#else
+            static constexpr endian host_endian = little;
+#endif
+
             typedef variant<
                     bool,
                     unsigned char,
@@ -305,34 +888,421 @@ namespace ed25519 {
                     Data<size::double_hash>
             > variant_t;
 
-            virtual void append(const variant_t &value) = 0;
+            /**
+             * Append a value of any supported type
+             * @param value - variant value
+             */
+            virtual void append(const variant_t &value);
+
+            /**
+             * Typed appends: scalars are encoded on the stack, strings, vectors and keys
+             * are absorbed in place, nothing is copied to the heap.
+             * A string literal converts to bool here as it does to variant_t,
+             * pass std::string_view to append its characters.
+             */
+            void append(bool value);
+            void append(unsigned char value);
+            void append(short int value);
+            void append(int value);
+            void append(std::string_view value);
+            void append(const std::string &value);
+            void append(const std::vector<unsigned char> &value);
+            void append(const Data<size::hash> &value);
+            void append(const Data<size::double_hash> &value);
+
             virtual void set_endian(endian) = 0;
             virtual endian get_endian() = 0;
 
+            virtual ~Calculator() = default;
+
             friend class keys::Pair;
+
+        protected:
+            /**
+             * Absorb raw bytes
+             * @param data - bytes
+             * @param size - number of bytes
+             */
+            virtual void update(const void *data, size_t size) = 0;
         };
 
         typedef std::function<void(Calculator &)> context;
 
-        friend struct Digest::Calculator;
-        friend class keys::Public;
         /**
-         * Create new digest from variant types
-         * @param handler - calculator handler
+         * Enables template overloads taking a calculator handler by any callable type,
+         * the handler is called directly instead of being wrapped into context
          */
-        explicit Digest(const context& handler);
-
-        Digest();
+        template<typename Handler, typename Self>
+        using enable_if_handler = std::enable_if_t<std::conjunction_v<
+                std::negation<std::is_same<std::decay_t<Handler>, Self>>,
+                std::negation<std::is_same<std::decay_t<Handler>, context>>,
+                std::is_invocable<Handler&, Calculator&>>>;
 
         /**
-       * Restore digest from base58-encoded string
-       * @param base58 encoded signature
-       * @param error handler
-       * @return nullopt or new digest hash object
-       */
-        static  std::optional<Digest> Decode(const std::string &base58, const ErrorHandler &error = default_error_handler);
-    };
-
+         * Incremental SHA3-256 sponge. The state is a plain value: a copy continues
+         * independently from the bytes absorbed so far.
+         */
+        class State {
+        public:
+            State();
+
+            /**
+             * Absorb bytes
+             * @param data - bytes
+             * @param size - number of bytes
+             */
+            void update(const void *data, size_t size);
+
+            /**
+             * Pad, permute and write the hash, the state must not be updated after
+             * @param digest - result
+             */
+            void finalize(Digest &digest);
+
+        private:
+            /** sizeof(sha3_context), checked in digest.cpp */
+            static constexpr size_t context_size = 224;
+            alignas(8) unsigned char context_[context_size];
+        };
+
+        /**
+         * Hash function of a digest. SHA3-256 is the default and the one every record
+         * exchanged with other implementations must use. BLAKE3 is several times faster,
+         * it is meant for internal records hashed with this library on both sides.
+         */
+        enum algorithm {
+            sha3_256 = 0,
+            blake3 = 1
+        };
+
+        friend struct Digest::Calculator;
+        friend class keys::Public;
+        /**
+         * Create new digest from variant types
+         * @param handler - calculator handler
+         */
+        explicit Digest(const context& handler);
+
+        /**
+         * Create new digest from variant types with the given hash function.
+         * The calculator hashes on the calling thread, Digest::Blake3 splits large payloads over threads
+         * @param handler - calculator handler
+         * @param hash - hash function
+         */
+        Digest(const context& handler, algorithm hash);
+
+        /**
+         * Create new digest calling any callable with the calculator directly,
+         * without wrapping it into std::function
+         * @param handler - calculator handler
+         */
+        template<typename Handler, typename = enable_if_handler<Handler, Digest>>
+        explicit Digest(Handler &&handler):Data<size::digest>() {
+          calculate(&invoke<Handler>, pointer_of(handler));
+        }
+
+        template<typename Handler, typename = enable_if_handler<Handler, Digest>>
+        Digest(Handler &&handler, algorithm hash):Data<size::digest>() {
+          calculate(&invoke<Handler>, pointer_of(handler), hash);
+        }
+
+        Digest();
+
+        /**
+         * Digest of a plain record
+         * @param bytes - digest bytes
+         */
+        explicit Digest(const DigestBytes &bytes):Data<size::digest>() {
+          std::copy(bytes.begin(), bytes.end(), begin());
+        }
+
+        /**
+         * Copy to a plain record
+         * @return digest bytes
+         */
+        [[nodiscard]] DigestBytes bytes() const {
+          DigestBytes bytes;
+          std::copy(begin(), end(), bytes.begin());
+          return bytes;
+        }
+
+        /**
+         * Calculate digests of many records at once. Records are hashed in parallel
+         * SIMD lanes: 8 with AVX-512, 4 with AVX2, one by one otherwise.
+         * Every result is identical to Digest(handler).
+         * @param handlers - calculator handler of every record
+         * @return digests in the order of handlers
+         */
+        static std::vector<Digest> Bulk(const std::vector<context> &handlers);
+
+        /**
+         * ParallelHash256 (NIST SP 800-185) of a large payload, 256-bit output.
+         * Blocks of the payload are hashed with SHAKE256 on several threads and in
+         * parallel SIMD lanes, then the chained values are combined with cSHAKE256.
+         * It is a different function than Digest(context), both sides must use it.
+         * @param data - payload
+         * @param size - payload size
+         * @param block_size - block size B in bytes, it must be positive
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @param customization - customization string S
+         * @return digest
+         * @throw std::invalid_argument if block_size is 0
+         */
+        static Digest ParallelHash(const unsigned char *data, size_t size,
+                                   size_t block_size = 8192,
+                                   size_t threads = 0,
+                                   std::string_view customization = {});
+
+        /**
+         * ParallelHash256 of a large payload
+         * @param data - payload
+         * @param block_size - block size B in bytes, it must be positive
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @param customization - customization string S
+         * @return digest
+         * @throw std::invalid_argument if block_size is 0
+         */
+        static Digest ParallelHash(const std::vector<unsigned char> &data,
+                                   size_t block_size = 8192,
+                                   size_t threads = 0,
+                                   std::string_view customization = {});
+
+        /**
+         * BLAKE3 of a large payload, equal to Digest(handler, blake3) appending the same
+         * bytes. Chunks are compressed in parallel SIMD lanes (16 with AVX-512, 8 with AVX2)
+         * and subtrees of the payload are hashed on several threads.
+         * @param data - payload
+         * @param size - payload size
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @return digest
+         */
+        static Digest Blake3(const unsigned char *data, size_t size, size_t threads = 0);
+
+        /**
+         * BLAKE3 of a large payload
+         * @param data - payload
+         * @param threads - number of threads, 0 uses every hardware thread
+         * @return digest
+         */
+        static Digest Blake3(const std::vector<unsigned char> &data, size_t threads = 0);
+
+        /**
+         * Create new digest from typed fields. The encoding of every field is resolved
+         * at compile time, output is byte-for-byte equal to the calculator appending the
+         * same fields with the same endianness. When every field has a fixed width
+         * (bool, unsigned char, short int, int, Data<N>) the record is packed into one
+         * stack buffer and absorbed at once.
+         * @tparam E - endianness of short int and int fields
+         * @param fields - bool, unsigned char, short int, int, std::string, std::string_view,
+         * std::vector<unsigned char>, Data<N> and keys
+         * @return digest
+         */
+        template<Calculator::endian E = Calculator::host_endian, typename... Fields>
+        static Digest of(const Fields &... fields) {
+          Digest digest;
+          if constexpr (((field<Fields>::size > 0) && ...)) {
+            std::array<unsigned char, (field<Fields>::size + ... + 0)> buffer{};
+            size_t offset = 0;
+            ((pack<E>(fields, buffer.data() + offset), offset += field<Fields>::size), ...);
+            State state;
+            state.update(buffer.data(), buffer.size());
+            state.finalize(digest);
+          }
+          else {
+            State state;
+            (absorb<E>(state, fields), ...);
+            state.finalize(digest);
+          }
+          return digest;
+        }
+
+        /**
+       * Restore digest from base58-encoded string
+       * @param base58 encoded signature
+       * @param error handler
+       * @return nullopt or new digest hash object
+       */
+        static  std::optional<Digest> Decode(const std::string &base58, const ErrorHandler &error = default_error_handler);
+
+        /**
+         * Restore digest from base58-encoded string without allocations
+         * @param base58 encoded string
+         * @return value or the reason of the failure
+         */
+        static  expected<Digest> TryDecode(std::string_view base58);
+
+        /**
+       * Restore digest from hex string
+       * @param hex digest
+       * @param error handler
+       * @return nullopt or new digest hash object
+       */
+        static  std::optional<Digest> FromHex(std::string_view hex, const ErrorHandler &error = default_error_handler);
+
+        /**
+         * Calculator state after a common prefix of many digests. The prefix is absorbed
+         * once, every finish() continues from a copy of the state.
+         */
+        class Prefix {
+        public:
+            /**
+             * Absorb the common prefix
+             * @param handler - calculator handler appending the prefix fields
+             */
+            explicit Prefix(const context &handler);
+
+            template<typename Handler, typename = enable_if_handler<Handler, Prefix>>
+            explicit Prefix(Handler &&handler) {
+              absorb(&invoke<Handler>, pointer_of(handler));
+            }
+
+            /**
+             * Calculate a digest of the prefix followed by the handler fields.
+             * The calculator starts with the endianness the prefix ended with.
+             * @param handler - calculator handler appending the trailing fields
+             * @return digest
+             */
+            Digest finish(const context &handler) const;
+
+            template<typename Handler, typename = enable_if_handler<Handler, Prefix>>
+            Digest finish(Handler &&handler) const {
+              return calculate(&invoke<Handler>, pointer_of(handler));
+            }
+
+            /**
+             * Digest of the prefix alone
+             * @return digest
+             */
+            Digest finish() const;
+
+        private:
+            State state_;
+            Calculator::endian endian_ = Calculator::host_endian;
+
+            void absorb(void (*invoke)(void *handler, Calculator &calculator), void *handler);
+            Digest calculate(void (*invoke)(void *handler, Calculator &calculator), void *handler) const;
+        };
+
+    private:
+        void calculate(void (*invoke)(void *handler, Calculator &calculator), void *handler,
+                       algorithm hash = sha3_256);
+
+        template<typename Handler>
+        static void invoke(void *handler, Calculator &calculator) {
+          (*static_cast<std::remove_reference_t<Handler> *>(handler))(calculator);
+        }
+
+        template<typename Handler>
+        static void *pointer_of(Handler &handler) {
+          return const_cast<void *>(static_cast<const void *>(std::addressof(handler)));
+        }
+
+        template<size_t N> static std::integral_constant<size_t, N> data_size(const Data<N> *);
+        static std::integral_constant<size_t, 0> data_size(...);
+
+        template<typename T>
+        struct field {
+            static constexpr bool is_bytes =
+                    std::is_same_v<T, std::string> ||
+                    std::is_same_v<T, std::string_view> ||
+                    std::is_same_v<T, std::vector<unsigned char>>;
+
+            /** encoded width of a fixed-size field, 0 for byte strings */
+            static constexpr size_t size =
+                    std::is_same_v<T, bool> || std::is_same_v<T, unsigned char> ? 1 :
+                    std::is_same_v<T, short int> ? sizeof(short int) :
+                    std::is_same_v<T, int> ? sizeof(int) :
+                    decltype(data_size(std::declval<const T *>()))::value;
+
+            static_assert(size > 0 || is_bytes,
+                          "Digest::of supports bool, unsigned char, short int, int, std::string, "
+                          "std::string_view, std::vector<unsigned char> and Data<N>; "
+                          "pass string literals as std::string_view");
+        };
+
+        template<Calculator::endian E, typename T>
+        static void pack(const T &value, unsigned char *out) {
+          if constexpr (std::is_same_v<T, bool>) {
+            out[0] = value ? 1 : 0;
+          }
+          else if constexpr (std::is_same_v<T, short int> || std::is_same_v<T, int>) {
+            auto v = static_cast<std::make_unsigned_t<T>>(value);
+            for (size_t i = 0; i < sizeof(T); ++i) {
+              auto shift = 8 * (E == Calculator::little ? i : sizeof(T) - 1 - i);
+              out[i] = static_cast<unsigned char>((v >> shift) & 0xff);
+            }
+          }
+          else if constexpr (std::is_same_v<T, unsigned char>) {
+            out[0] = value;
+          }
+          else {
+            std::copy_n(value.data(), field<T>::size, out);
+          }
+        }
+
+        template<Calculator::endian E, typename T>
+        static void absorb(State &state, const T &value) {
+          if constexpr (field<T>::is_bytes) {
+            state.update(value.data(), value.size());
+          }
+          else {
+            std::array<unsigned char, field<T>::size> buffer{};
+            pack<E>(value, buffer.data());
+            state.update(buffer.data(), buffer.size());
+          }
+        }
+    };
+
+    /**
+     * Optional process-wide cache of successful verifications: a triple of signature, public key
+     * and message that has been verified once is accepted again without the curve math.
+     * Tags are 128-bit keyed hashes in a fixed table, failed verifications are not cached.
+     */
+    namespace verify_cache {
+
+        constexpr const size_t default_entries = 64 * 1024;
+
+        struct statistics {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t insertions;
+
+            /** number of tags the cache holds, 0 if it is disabled */
+            size_t capacity;
+
+            double hit_rate() const {
+              return hits + misses == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+            }
+        };
+
+        /**
+         * Enable an empty cache, 16 bytes per entry
+         * @param entries number of tags, rounded up to a power of two, at most 2^28
+         * @return false if entries is above 2^28, the table cannot be allocated or the random key
+         * of the cache cannot be drawn, the cache is disabled then
+         */
+        bool enable(size_t entries = default_entries);
+
+        /**
+         * Disable and free the cache
+         */
+        void disable();
+
+        /**
+         * Cache is enabled
+         */
+        bool enabled();
+
+        /**
+         * Forget cached verifications and reset counters
+         */
+        void clear();
+
+        /**
+         * Counters of the cache since it was enabled or cleared
+         */
+        statistics stats();
+    }
 
     /**
      * Sigature hash class
@@ -340,6 +1310,24 @@ namespace ed25519 {
     class Signature : public ProtectedData<size::signature> {
     public:
 
+        /**
+         * Signature of a plain record
+         * @param bytes - signature bytes
+         */
+        explicit Signature(const SignatureBytes &bytes):ProtectedData<size::signature>() {
+          std::copy(bytes.begin(), bytes.end(), begin());
+        }
+
+        /**
+         * Copy to a plain record
+         * @return signature bytes
+         */
+        [[nodiscard]] SignatureBytes bytes() const {
+          SignatureBytes bytes;
+          std::copy(begin(), end(), bytes.begin());
+          return bytes;
+        }
+
         /**
          * Restore signature from base58-encoded string
          * @param base58 encoded signature
@@ -348,6 +1336,21 @@ namespace ed25519 {
          */
         static  std::optional<Signature> Decode(const std::string &base58, const ErrorHandler &error = default_error_handler);
 
+        /**
+         * Restore signature from base58-encoded string without allocations
+         * @param base58 encoded string
+         * @return value or the reason of the failure
+         */
+        static  expected<Signature> TryDecode(std::string_view base58);
+
+        /**
+         * Restore signature from hex string
+         * @param hex signature
+         * @param error handler
+         * @return nullopt or new signature hash object
+         */
+        static  std::optional<Signature> FromHex(std::string_view hex, const ErrorHandler &error = default_error_handler);
+
         /**
          * Verify message with public key
          * @param message data
@@ -358,11 +1361,11 @@ namespace ed25519 {
 
         /**
          * Verify message with public key
-         * @param message string
+         * @param message string, it is not copied
          * @param key public key
          * @return true if message was signed by private key of the pair
          */
-        [[nodiscard]] bool verify(const std::string& message, const keys::Public& key) const ;
+        [[nodiscard]] bool verify(std::string_view message, const keys::Public& key) const ;
 
         /**
          * Verify message with public key
@@ -372,6 +1375,30 @@ namespace ed25519 {
          */
         [[nodiscard]] bool verify(const Digest& digest, const keys::Public& key) const ;
 
+        /**
+         * Verify message with a plain public key record
+         * @param message string, it is not copied
+         * @param key public key bytes
+         * @return true if message was signed by private key of the pair
+         */
+        [[nodiscard]] bool verify(std::string_view message, const PublicKeyBytes& key) const ;
+
+        /**
+         * Verify digest with a plain public key record
+         * @param digest data
+         * @param key public key bytes
+         * @return true if message was signed by private key of the pair
+         */
+        [[nodiscard]] bool verify(const Digest& digest, const PublicKeyBytes& key) const ;
+
+        using ProtectedData<size::signature>::validate;
+
+        /**
+         * Validate signature in place: S is a canonical scalar, less than the group order
+         * @return true if the signature is canonical
+         */
+        bool validate() const override;
+
         virtual ~Signature() = default;
         
     protected:
@@ -379,6 +1406,24 @@ namespace ed25519 {
         friend class keys::Pair;
     };
 
+    /**
+     * Verify a plain signature record with a plain public key record, as Signature::verify does
+     * @param signature signature bytes
+     * @param message string, it is not copied
+     * @param key public key bytes
+     * @return true if message was signed by private key of the pair
+     */
+    [[nodiscard]] bool verify(const SignatureBytes &signature, std::string_view message, const PublicKeyBytes &key);
+
+    /**
+     * Verify a plain signature record of a digest
+     * @param signature signature bytes
+     * @param digest digest bytes
+     * @param key public key bytes
+     * @return true if digest was signed by private key of the pair
+     */
+    [[nodiscard]] bool verify(const SignatureBytes &signature, const DigestBytes &digest, const PublicKeyBytes &key);
+
     /**
      * Seed generator
      */
@@ -396,7 +1441,8 @@ namespace ed25519 {
         explicit Seed(const std::string &phrase);
 
         /**
-         * Create random seed
+         * Create random seed of the calling thread's ChaCha20 generator keyed by the system source
+         * @throw std::system_error if the system source is unavailable
          */
         Seed();
     };
@@ -405,12 +1451,61 @@ namespace ed25519 {
         template <size_t N>
         class Key: public ProtectedData<N> {};
 
+        /**
+         * Scalar added to a parent key to derive a child, the highest bit is ignored
+         */
+        typedef std::array<unsigned char, size::tweak> Tweak;
+
         /**
          * Public key representaion
          */
         class Public: public Key<size::public_key>{
         public:
+            Public() = default;
+
+            /**
+             * Public key of raw bytes, e.g. of a _pubkey literal
+             * @param bytes - compressed point
+             */
+            explicit Public(const std::array<unsigned char, size::public_key> &bytes) {
+              std::copy(bytes.begin(), bytes.end(), data());
+            }
+
+            /**
+             * Copy to a plain record
+             * @return public key bytes
+             */
+            [[nodiscard]] PublicKeyBytes bytes() const {
+              PublicKeyBytes bytes;
+              std::copy(begin(), end(), bytes.begin());
+              return bytes;
+            }
+
             static  std::optional<Public> Decode(const std::string &base58, const ErrorHandler &error = default_error_handler);
+
+            /**
+             * Restore public key from base58-encoded string without allocations
+             * @param base58 encoded string
+             * @return value or the reason of the failure
+             */
+            static  expected<Public> TryDecode(std::string_view base58);
+
+            using Key<size::public_key>::validate;
+
+            /**
+             * Validate public key in place: the y coordinate is canonical and the point is on the curve
+             * @return true if the key is a valid point
+             */
+            bool validate() const override;
+
+            /**
+             * Derive child public key A + tweak * B, as ed25519_add_scalar without private key does
+             * @param tweak scalar
+             * @return nullopt if the key is not a point or child key
+             */
+            [[nodiscard]] std::optional<Public> derive(const Tweak &tweak) const;
+
+            static  std::optional<Public> FromHex(std::string_view hex, const ErrorHandler &error = default_error_handler);
         };
 
         /**
@@ -419,6 +1514,22 @@ namespace ed25519 {
         class Private: public Key<size::private_key>{
         public:
             static  std::optional<Private> Decode(const std::string &base58, const ErrorHandler &error = default_error_handler);
+
+            /**
+             * Restore private key from base58-encoded string without allocations
+             * @param base58 encoded string
+             * @return value or the reason of the failure
+             */
+            static  expected<Private> TryDecode(std::string_view base58);
+
+            using Key<size::private_key>::validate;
+
+            /**
+             * Validate private key in place: the scalar is clamped as by key generation
+             * or reduced below the group order as by key derivation
+             * @return true if the scalar is valid
+             */
+            bool validate() const override;
         private:
             bool decode(const std::string &base58, const ErrorHandler &error = default_error_handler) override {
               return Data<size::signature>::decode(base58, error);
@@ -426,6 +1537,18 @@ namespace ed25519 {
             friend class keys::Pair;
         };
 
+        /**
+         * X25519 public key: Montgomery u-coordinate (RFC 7748)
+         */
+        typedef Data<size::exchange_key> ExchangeKey;
+
+        /**
+         * Shared secret of a key exchange
+         */
+        typedef Data<size::shared_secret> SharedSecret;
+
+        class PreparedPeer;
+
         /**
          * Pair key representation
          */
@@ -441,10 +1564,20 @@ namespace ed25519 {
 
             /**
              * Create random pair
-             * @return always exists private key
+             * @return pair or nullopt if the system random source is unavailable
              */
             static std::optional<Pair> Random();
 
+            /**
+             * Create random pairs in bulk: seeds are drawn at once and the public keys of a batch
+             * share one field inversion, ranges of pairs are generated on several threads
+             * @param count number of pairs
+             * @param threads number of threads, 0 is the number of hardware threads
+             * @return count pairs
+             * @throw std::system_error if the system random source is unavailable
+             */
+            static std::vector<Pair> Generate(size_t count, size_t threads = 0);
+
             /**
             * Create random pair
             * @return always exists private key
@@ -466,10 +1599,10 @@ namespace ed25519 {
             void clean();
 
             /**
-             * Vlidate pair
+             * Validate pair in place: both keys are valid and the public key is the one of the private key
              * @return validation result
              */
-            bool validate();
+            bool validate() const;
 
             /**
              * Sign a message
@@ -480,10 +1613,10 @@ namespace ed25519 {
 
             /**
              * Sign a message
-             * @param message string
+             * @param message string, it is not copied
              * @return signature hash
              */
-            std::unique_ptr<Signature> sign(const std::string &message);
+            std::unique_ptr<Signature> sign(std::string_view message);
 
             /**
              * Sign a digest
@@ -492,6 +1625,87 @@ namespace ed25519 {
              */
             std::unique_ptr<Signature> sign(const Digest& digest);
 
+            /**
+             * Sign a message, the signature is allocated in a memory resource
+             * @param message data
+             * @param resource memory resource
+             * @return signature hash
+             */
+            pmr::unique_ptr<Signature> sign(const std::vector<unsigned char>& message, std::pmr::memory_resource *resource);
+
+            /**
+             * Sign a message, the signature is allocated in a memory resource
+             * @param message string, e.g. std::pmr::string
+             * @param resource memory resource
+             * @return signature hash
+             */
+            pmr::unique_ptr<Signature> sign(std::string_view message, std::pmr::memory_resource *resource);
+
+            /**
+             * Sign a digest, the signature is allocated in a memory resource
+             * @param digest data
+             * @param resource memory resource
+             * @return signature hash
+             */
+            pmr::unique_ptr<Signature> sign(const Digest& digest, std::pmr::memory_resource *resource);
+
+            /**
+             * Sign a message to a plain record, nothing is allocated
+             * @param message string
+             * @return signature bytes
+             */
+            [[nodiscard]] SignatureBytes sign_bytes(std::string_view message) const;
+
+            /**
+             * Sign a byte message to a plain record, nothing is allocated
+             * @param message bytes
+             * @return signature bytes
+             */
+            [[nodiscard]] SignatureBytes sign_bytes(const std::vector<unsigned char> &message) const;
+
+            /**
+             * Sign a digest to a plain record, nothing is allocated
+             * @param digest bytes
+             * @return signature bytes
+             */
+            [[nodiscard]] SignatureBytes sign_bytes(const DigestBytes &digest) const;
+
+            /**
+             * Exchange with the public key of the peer, as ed25519_key_exchange does
+             * @param peer Edwards public key
+             * @return shared secret
+             */
+            [[nodiscard]] SharedSecret exchange(const Public &peer) const;
+
+            /**
+             * Exchange with the plain public key record of the peer
+             * @param peer Edwards public key bytes
+             * @return shared secret, equal to exchange(Public(peer))
+             */
+            [[nodiscard]] SharedSecret exchange(const PublicKeyBytes &peer) const;
+
+            /**
+             * Derive child pair a + tweak, as ed25519_add_scalar does,
+             * the public key is equal to get_public_key().derive(tweak)
+             * @param tweak scalar
+             * @return child pair
+             */
+            [[nodiscard]] Pair derive(const Tweak &tweak) const;
+
+            /**
+             * Exchange with a peer converted to Montgomery form once
+             * @param peer prepared peer
+             * @return shared secret, equal to exchange(peer.get_public_key())
+             */
+            [[nodiscard]] SharedSecret exchange(const PreparedPeer &peer) const;
+
+            /**
+             * X25519 exchange with the ephemeral key of the peer
+             * @param peer Montgomery u-coordinate
+             * @return shared secret
+             */
+            [[nodiscard]] SharedSecret exchange(const ExchangeKey &peer) const;
+
             ~Pair() {
               clean();
             }
@@ -501,7 +1715,369 @@ namespace ed25519 {
             Public publicKey_;
             Private privateKey_;
         };
+
+        /**
+         * Ephemeral X25519 key pair of a handshake. The public key is the Edwards fixed-base product
+         * mapped to Montgomery u, several times cheaper than a ladder over the base point.
+         */
+        class Ephemeral {
+
+        public:
+            /**
+             * Create random ephemeral pair
+             * @return pair or nullopt if the system random source is unavailable
+             */
+            static std::optional<Ephemeral> Random();
+
+            /**
+             * Restore ephemeral pair from a base58-encoded 32-byte X25519 private key
+             * @param privateKey encoded private key
+             * @param error error handler
+             * @return nullopt or pair
+             */
+            static std::optional<Ephemeral> FromPrivateKey(const std::string &privateKey,
+                                                           const ErrorHandler &error = default_error_handler);
+
+            /**
+             * Get public key to send to the peer
+             * @return Montgomery u-coordinate
+             */
+            [[nodiscard]] const ExchangeKey &get_public_key() const { return publicKey_; };
+
+            /**
+             * X25519 exchange with the ephemeral key of the peer
+             * @param peer Montgomery u-coordinate
+             * @return shared secret
+             */
+            [[nodiscard]] SharedSecret exchange(const ExchangeKey &peer) const;
+
+            /**
+             * Exchange with an ed25519 public key, as ed25519_key_exchange does
+             * @param peer Edwards public key
+             * @return shared secret
+             */
+            [[nodiscard]] SharedSecret exchange(const Public &peer) const;
+
+            /**
+             * Exchange with the plain public key record of the peer
+             * @param peer Edwards public key bytes
+             * @return shared secret, equal to exchange(Public(peer))
+             */
+            [[nodiscard]] SharedSecret exchange(const PublicKeyBytes &peer) const;
+
+            /**
+             * Clean pair
+             */
+            void clean();
+
+            ~Ephemeral() {
+              clean();
+            }
+
+        private:
+            Ephemeral();
+            Data<size::exchange_key> privateKey_;
+            ExchangeKey publicKey_;
+        };
+
+        /**
+         * Public key of a peer with its Montgomery u-coordinate computed once,
+         * repeated exchanges with the peer skip the conversion and its field inversion
+         */
+        class PreparedPeer {
+
+        public:
+            /**
+             * Convert peer key
+             * @param peer Edwards public key
+             */
+            explicit PreparedPeer(const Public &peer);
+
+            /**
+             * Convert plain peer key record
+             * @param peer Edwards public key bytes
+             */
+            explicit PreparedPeer(const PublicKeyBytes &peer);
+
+            /**
+             * Convert many peer keys, conversions share one field inversion per batch
+             * @param peers Edwards public keys
+             * @return prepared peers in the order of peers
+             */
+            static std::vector<PreparedPeer> Prepare(const std::vector<Public> &peers);
+
+            /**
+             * Convert many plain peer key records, as Prepare(peers) does
+             * @param peers Edwards public key bytes
+             * @return prepared peers in the order of peers
+             */
+            static std::vector<PreparedPeer> PrepareBytes(const std::vector<PublicKeyBytes> &peers);
+
+            [[nodiscard]] const Public &get_public_key() const { return publicKey_; };
+
+            /**
+             * Get converted key
+             * @return Montgomery u-coordinate
+             */
+            [[nodiscard]] const ExchangeKey &get_exchange_key() const { return exchangeKey_; };
+
+        private:
+            PreparedPeer() = default;
+
+            template<typename Key>
+            static std::vector<PreparedPeer> prepare(const std::vector<Key> &peers);
+
+            Public publicKey_;
+            ExchangeKey exchangeKey_;
+        };
+
+        /**
+         * Parent public key decompressed once, children are derived without decoding the parent again
+         */
+        class PreparedParent {
+
+        public:
+            /**
+             * Decompress parent key
+             * @param parent public key
+             * @param error error handler
+             * @return nullopt if the key is not a point or prepared parent
+             */
+            static std::optional<PreparedParent> Prepare(const Public &parent,
+                                                         const ErrorHandler &error = default_error_handler);
+
+            static std::optional<PreparedParent> Prepare(const PublicKeyBytes &parent,
+                                                         const ErrorHandler &error = default_error_handler);
+
+            [[nodiscard]] const Public &get_public_key() const { return publicKey_; };
+
+            /**
+             * Derive child public key
+             * @param tweak scalar
+             * @return child key, equal to get_public_key().derive(tweak)
+             */
+            [[nodiscard]] Public derive(const Tweak &tweak) const;
+
+            /**
+             * Derive many children, encodings of a batch share one field inversion
+             * and ranges of tweaks are derived on several threads
+             * @param tweaks scalars
+             * @param threads number of threads, 0 is the number of hardware threads
+             * @return child keys in the order of tweaks
+             */
+            [[nodiscard]] std::vector<Public> derive(const std::vector<Tweak> &tweaks, size_t threads = 0) const;
+
+            /**
+             * Derive child public key to a plain record
+             * @param tweak scalar
+             * @return child key bytes, equal to derive(tweak).bytes()
+             */
+            [[nodiscard]] PublicKeyBytes derive_bytes(const Tweak &tweak) const;
+
+            /**
+             * Derive many children to dense plain records, as derive(tweaks, threads) does
+             * @param tweaks scalars
+             * @param threads number of threads, 0 is the number of hardware threads
+             * @return child key bytes in the order of tweaks
+             */
+            [[nodiscard]] std::vector<PublicKeyBytes> derive_bytes(const std::vector<Tweak> &tweaks,
+                                                                   size_t threads = 0) const;
+
+        private:
+            PreparedParent() = default;
+
+            template<typename Key>
+            std::vector<Key> derive_all(const std::vector<Tweak> &tweaks, size_t threads) const;
+
+            Public publicKey_;
+            std::array<unsigned char, 160> point_;
+        };
+
+        /**
+         * Derive child of a plain public key record, as Public::derive does
+         * @param parent public key bytes
+         * @param tweak scalar
+         * @return nullopt if the key is not a point or child key bytes
+         */
+        [[nodiscard]] std::optional<PublicKeyBytes> derive(const PublicKeyBytes &parent, const Tweak &tweak);
     }
 
+    /**
+     * Pipelined verification service. Requests go through bounded lock-free queues to two stages:
+     * hash threads compute SHA-512 of R || A || M, curve threads check the signature equation of one
+     * request at a time, exactly as Signature::verify does. The verification cache is consulted after hashing and populated after the curve check.
+     */
+    class Verifier {
+    public:
+        /**
+         * Completion callback, called once on a worker thread; it must not throw.
+         * Its request stays in flight until it returns, so it must not call wait() or destroy
+         * the Verifier: that deadlocks, debug builds assert
+         */
+        typedef std::function<void(bool verified)> Completion;
+
+        /**
+         * Start workers
+         * @param hash_threads number of hashing threads
+         * @param curve_threads number of curve threads, 0 is the number of hardware threads
+         * @param queue_size capacity of every stage queue, rounded up to a power of two
+         */
+        explicit Verifier(size_t hash_threads = 1, size_t curve_threads = 0, size_t queue_size = 1024);
+
+        Verifier(const Verifier &) = delete;
+        Verifier &operator=(const Verifier &) = delete;
+
+        /**
+         * Complete every submitted request and stop workers, must not be called from a completion
+         */
+        ~Verifier();
+
+        /**
+         * Submit request, blocks while the queue is full
+         * @param signature signature
+         * @param key public key
+         * @param message message, moved into the request
+         * @param completion callback
+         */
+        void submit(const Signature &signature, const keys::Public &key, std::vector<unsigned char> message,
+                    Completion completion);
+
+        void submit(const Signature &signature, const keys::Public &key, std::string_view message,
+                    Completion completion);
+
+        void submit(const SignatureBytes &signature, const PublicKeyBytes &key, std::vector<unsigned char> message,
+                    Completion completion);
+
+        void submit(const SignatureBytes &signature, const PublicKeyBytes &key, std::string_view message,
+                    Completion completion);
+
+        /**
+         * Submit request without blocking
+         * @return false if the queue is full, the request is not taken then
+         */
+        bool try_submit(const Signature &signature, const keys::Public &key, std::vector<unsigned char> message,
+                        Completion completion);
+
+        bool try_submit(const Signature &signature, const keys::Public &key, std::string_view message,
+                        Completion completion);
+
+        bool try_submit(const SignatureBytes &signature, const PublicKeyBytes &key, std::vector<unsigned char> message,
+                        Completion completion);
+
+        bool try_submit(const SignatureBytes &signature, const PublicKeyBytes &key, std::string_view message,
+                        Completion completion);
+
+        /**
+         * Wait until every submitted request is completed, must not be called from a completion
+         */
+        void wait();
+
+    private:
+        struct pipeline;
+        std::unique_ptr<pipeline> pipeline_;
+    };
+
+    /**
+     * Immutable key, signature or digest with its base58 string computed once, on first use.
+     * Readers may share an object between threads; decode() and clean() are writers.
+     * @tparam T - keys::Public, Signature or Digest
+     */
+    template <typename T>
+    class Encoded {
+    public:
+        static constexpr size_t size = decltype(base58::array_size_of(static_cast<const T *>(nullptr)))::value;
+
+        typedef base58::fixed_string<base58::max_encoded_size<size>> string_type;
+
+        explicit Encoded(const T &value): value_(value), state_(empty) {}
+
+        Encoded(const Encoded &other): value_(other.value_), state_(empty) {
+          copy_string(other);
+        }
+
+        Encoded &operator=(const Encoded &other) {
+          if (this != &other) {
+            value_ = other.value_;
+            state_.store(empty, std::memory_order_relaxed);
+            copy_string(other);
+          }
+          return *this;
+        }
+
+        const T &get() const { return value_; }
+
+        operator const T &() const { return value_; }
+
+        /**
+         * Base58 string of the value, the same as get().encode()
+         * @return view of the cached string, valid while the object is not changed
+         */
+        std::string_view encode() const {
+          if (state_.load(std::memory_order_acquire) != ready)
+            compute();
+          return string_;
+        }
+
+        /**
+         * Replace the value by a decoded one, the cached string is dropped
+         * @param base58 encoded string
+         * @param error - error handler
+         * @return false if decoding is failed, the value is not changed then
+         */
+        bool decode(const std::string &base58, const ErrorHandler &error = default_error_handler) {
+          auto decoded = T::Decode(base58, error);
+          if (!decoded)
+            return false;
+          value_ = *decoded;
+          state_.store(empty, std::memory_order_relaxed);
+          return true;
+        }
+
+        /**
+         * Clean the value memory and the cached string
+         */
+        void clean() {
+          value_.clean();
+          string_ = string_type();
+          state_.store(empty, std::memory_order_relaxed);
+        }
+
+        bool operator==(const Encoded &other) const { return value_ == other.value_; }
+        bool operator!=(const Encoded &other) const { return !(*this == other); }
+
+    private:
+        enum : unsigned char { empty, computing, ready };
+
+        T value_;
+        mutable string_type string_;
+        mutable std::atomic<unsigned char> state_;
+
+        /* one reader computes the string, the others wait for it */
+        void compute() const {
+          unsigned char expected = empty;
+          if (state_.compare_exchange_strong(expected, computing, std::memory_order_acquire)) {
+            string_ = base58::encode_fixed<size>(value_);
+            state_.store(ready, std::memory_order_release);
+            return;
+          }
+          while (state_.load(std::memory_order_acquire) != ready)
+            std::this_thread::yield();
+        }
+
+        void copy_string(const Encoded &other) {
+          if (other.state_.load(std::memory_order_acquire) == ready) {
+            string_ = other.string_;
+            state_.store(ready, std::memory_order_relaxed);
+          }
+        }
+    };
+
+    namespace keys {
+        typedef Encoded<Public> EncodedPublic;
+    }
+
+    typedef Encoded<Signature> EncodedSignature;
+    typedef Encoded<Digest> EncodedDigest;
+
     std::string StringFormat(const char* format, ...);
 }
@@ -4,12 +4,305 @@
 
 #include "ed25519.hpp"
 #include "btc_base58.hpp"
+#include "crc32.hpp"
 #include <memory>
+#include <cctype>
+#include <cstdint>
 
 namespace ed25519{
 
     namespace base58 {
 
+        namespace {
+
+            constexpr const char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+            enum class fixed_status {
+                decoded,
+                unknown,
+                bad_character,
+                bad_checksum
+            };
+
+            /**
+             * Fixed-length base58 with checksum: T bytes are T/4 big-endian 32-bit words,
+             * the string is a number of 5-digit limbs in radix 58^5. Both directions
+             * multiply every limb by a precomputed power of the other radix and
+             * accumulate in 64 bits, carries are propagated every few rows.
+             * Output is the same as EncodeBase58/DecodeBase58Check.
+             * @tparam T - payload size with the checksum, multiple of 4
+             */
+            template<size_t T>
+            struct fixed_codec {
+
+                static_assert(T % 4 == 0, "payload with checksum must be a multiple of 4 bytes");
+
+                static constexpr size_t words = T / 4;
+                static constexpr size_t digits = T * 138 / 100 + 1;
+                static constexpr size_t limbs = (digits + 4) / 5;
+                static constexpr uint64_t radix = 58ULL * 58 * 58 * 58 * 58;
+
+                /* every product is below 2^32 * 58^5 < 2^62, 4 of them fit in a 64-bit accumulator */
+                static constexpr size_t rows_per_carry = 4;
+
+                /** encode_table[i] = 2^(32 * (words - 1 - i)) in radix 58^5, most significant limb first */
+                static constexpr auto make_encode_table() {
+                  std::array<std::array<uint64_t, limbs>, words> table{};
+                  std::array<uint64_t, limbs> power{};
+                  power[limbs - 1] = 1;
+                  for (size_t i = words; i-- > 0;) {
+                    table[i] = power;
+                    uint64_t carry = 0;
+                    for (size_t k = limbs; k-- > 0;) {
+                      uint64_t x = (power[k] << 32) + carry;
+                      power[k] = x % radix;
+                      carry = x / radix;
+                    }
+                  }
+                  return table;
+                }
+
+                /** decode_table[k] = 58^(5 * (limbs - 1 - k)) in 32-bit words, one extra word catches overflow */
+                static constexpr auto make_decode_table() {
+                  std::array<std::array<uint64_t, words + 1>, limbs> table{};
+                  std::array<uint64_t, words + 1> power{};
+                  power[words] = 1;
+                  for (size_t k = limbs; k-- > 0;) {
+                    table[k] = power;
+                    uint64_t carry = 0;
+                    for (size_t j = words + 1; j-- > 0;) {
+                      uint64_t x = power[j] * radix + carry;
+                      power[j] = x & 0xffffffffULL;
+                      carry = x >> 32;
+                    }
+                  }
+                  return table;
+                }
+
+                static constexpr auto encode_table = make_encode_table();
+                static constexpr auto decode_table = make_decode_table();
+
+                static size_t encode(const unsigned char *in, char *out) {
+
+                  uint64_t limb[limbs] = {};
+
+                  for (size_t i = 0; i < words; ++i) {
+                    uint64_t word = (uint64_t(in[4 * i]) << 24) | (uint64_t(in[4 * i + 1]) << 16) |
+                                    (uint64_t(in[4 * i + 2]) << 8) | uint64_t(in[4 * i + 3]);
+                    for (size_t k = 0; k < limbs; ++k)
+                      limb[k] += word * encode_table[i][k];
+                    if (i % rows_per_carry == rows_per_carry - 1 || i == words - 1) {
+                      for (size_t k = limbs - 1; k > 0; --k) {
+                        limb[k - 1] += limb[k] / radix;
+                        limb[k] %= radix;
+                      }
+                    }
+                  }
+
+                  unsigned char raw[limbs * 5];
+                  for (size_t k = 0; k < limbs; ++k) {
+                    uint64_t value = limb[k];
+                    for (size_t j = 5; j-- > 0;) {
+                      raw[5 * k + j] = static_cast<unsigned char>(value % 58);
+                      value /= 58;
+                    }
+                  }
+
+                  size_t zeroes = 0;
+                  while (zeroes < T && in[zeroes] == 0)
+                    zeroes++;
+
+                  size_t first = 0;
+                  while (first < sizeof(raw) && raw[first] == 0)
+                    first++;
+
+                  size_t size = 0;
+                  for (; size < zeroes; ++size)
+                    out[size] = '1';
+                  for (size_t i = first; i < sizeof(raw); ++i)
+                    out[size++] = alphabet[raw[i]];
+
+                  return size;
+                }
+
+                static bool decode(std::string_view str, unsigned char *out) {
+                  return decode_status(str, out) == fixed_status::decoded;
+                }
+
+                /* decode() telling failures the generic decoder also reports as BADFORMAT */
+                static fixed_status decode_status(std::string_view str, unsigned char *out) {
+
+                  size_t p = 0, n = str.size();
+                  auto space = [&str](size_t i) { return std::isspace(static_cast<unsigned char>(str[i])) != 0; };
+
+                  while (p < n && space(p))
+                    p++;
+
+                  size_t zeroes = 0;
+                  while (p < n && str[p] == '1') {
+                    zeroes++;
+                    p++;
+                  }
+
+                  size_t first = p;
+                  while (p < n && !space(p))
+                    p++;
+                  size_t count = p - first;
+
+                  while (p < n && space(p))
+                    p++;
+
+                  if (p != n || zeroes > T || count > limbs * 5)
+                    return fixed_status::unknown;
+
+                  uint64_t limb[limbs] = {};
+                  size_t position = limbs * 5 - count;
+                  for (size_t i = 0; i < count; ++i, ++position) {
+                    int d = mapBase58[static_cast<unsigned char>(str[first + i])];
+                    if (d < 0)
+                      return fixed_status::bad_character;
+                    limb[position / 5] = limb[position / 5] * 58 + static_cast<uint64_t>(d);
+                  }
+
+                  uint64_t word[words + 1] = {};
+
+                  for (size_t k = 0; k < limbs; ++k) {
+                    for (size_t j = 0; j <= words; ++j)
+                      word[j] += limb[k] * decode_table[k][j];
+                    if (k % rows_per_carry == rows_per_carry - 1 || k == limbs - 1) {
+                      for (size_t j = words; j > 0; --j) {
+                        word[j - 1] += word[j] >> 32;
+                        word[j] &= 0xffffffffULL;
+                      }
+                    }
+                  }
+
+                  // more than T bytes
+                  if (word[0] != 0)
+                    return fixed_status::unknown;
+
+                  unsigned char bytes[T];
+                  for (size_t j = 0; j < words; ++j) {
+                    bytes[4 * j]     = static_cast<unsigned char>(word[j + 1] >> 24);
+                    bytes[4 * j + 1] = static_cast<unsigned char>(word[j + 1] >> 16);
+                    bytes[4 * j + 2] = static_cast<unsigned char>(word[j + 1] >> 8);
+                    bytes[4 * j + 3] = static_cast<unsigned char>(word[j + 1]);
+                  }
+
+                  // the decoded length is the leading '1's plus the significant bytes
+                  size_t leading = 0;
+                  while (leading < T && bytes[leading] == 0)
+                    leading++;
+                  if (leading != zeroes)
+                    return fixed_status::unknown;
+
+                  uint_least32_t crc = crc32(bytes, T - 4);
+                  if (bytes[T - 4] != static_cast<unsigned char>(crc & 0xff) ||
+                      bytes[T - 3] != static_cast<unsigned char>((crc >> 8) & 0xff) ||
+                      bytes[T - 2] != static_cast<unsigned char>((crc >> 16) & 0xff) ||
+                      bytes[T - 1] != static_cast<unsigned char>((crc >> 24) & 0xff))
+                    return fixed_status::bad_checksum;
+
+                  std::copy_n(bytes, T - 4, out);
+                  return fixed_status::decoded;
+                }
+            };
+
+            template<size_t N>
+            fixed_string<max_encoded_size<N>> encode_with_checksum(const std::array<unsigned char, N> &data) {
+
+              static_assert(fixed_codec<N + 4>::digits == max_encoded_size<N>, "capacity mismatch");
+
+              unsigned char bytes[N + 4];
+              std::copy_n(data.begin(), N, bytes);
+
+              // little endian
+              uint_least32_t crc = crc32(bytes, N);
+              bytes[N]     = static_cast<unsigned char>(crc & 0xff);
+              bytes[N + 1] = static_cast<unsigned char>((crc >> 8) & 0xff);
+              bytes[N + 2] = static_cast<unsigned char>((crc >> 16) & 0xff);
+              bytes[N + 3] = static_cast<unsigned char>((crc >> 24) & 0xff);
+
+              fixed_string<max_encoded_size<N>> result;
+              result.resize(fixed_codec<N + 4>::encode(bytes, result.data()));
+              return result;
+            }
+
+            template<size_t N>
+            bool decode_with_checksum(std::string_view str, std::array<unsigned char, N> &data) {
+              std::array<unsigned char, N> bytes;
+              if (!fixed_codec<N + 4>::decode(str, bytes.data()))
+                return false;
+              data = bytes;
+              return true;
+            }
+        }
+
+        template<>
+        fixed_string<max_encoded_size<size::hash>> encode_fixed<size::hash>(
+                const std::array<unsigned char, size::hash> &data) {
+          return encode_with_checksum(data);
+        }
+
+        template<>
+        fixed_string<max_encoded_size<size::double_hash>> encode_fixed<size::double_hash>(
+                const std::array<unsigned char, size::double_hash> &data) {
+          return encode_with_checksum(data);
+        }
+
+        template<>
+        bool decode_fixed<size::hash>(std::string_view str, std::array<unsigned char, size::hash> &data) {
+          return decode_with_checksum(str, data);
+        }
+
+        template<>
+        bool decode_fixed<size::double_hash>(std::string_view str, std::array<unsigned char, size::double_hash> &data) {
+          return decode_with_checksum(str, data);
+        }
+
+        bool try_decode(std::string_view str, unsigned char *data, size_t size, decode_error &failure) noexcept {
+
+            failure = decode_error{error::BADFORMAT, 0, size};
+
+            auto status = fixed_status::unknown;
+            if (size == size::hash)
+                status = fixed_codec<size::hash + 4>::decode_status(str, data);
+            else if (size == size::double_hash)
+                status = fixed_codec<size::double_hash + 4>::decode_status(str, data);
+
+            if (status == fixed_status::decoded)
+                return true;
+            if (status != fixed_status::unknown)
+                return false;
+
+            // other sizes and lengths the fixed decoders do not take, '\0' is a bad character as for decode()
+            unsigned char vch[256];
+            size_t decoded = 0;
+
+            if (str.size() >= sizeof(vch)) {
+                // too long for the stack buffer and for any key: only the alphabet is checked
+                for (auto c: str) {
+                    if (mapBase58[static_cast<unsigned char>(c)] < 0 && !isspace(static_cast<unsigned char>(c)))
+                        return false;
+                }
+                failure.code = error::UNEXPECTED_SIZE;
+                failure.size = SIZE_MAX;
+                return false;
+            }
+
+            if (!DecodeBase58(str.data(), str.data() + str.size(), vch, sizeof(vch), decoded) || !CheckCrc32(vch, decoded))
+                return false;
+
+            if (decoded - 4 != size) {
+                failure.code = error::UNEXPECTED_SIZE;
+                failure.size = decoded - 4;
+                return false;
+            }
+
+            std::copy_n(vch, size, data);
+            return true;
+        }
+
         std::string encode(const std::vector<unsigned char> &data) {
             return EncodeBase58(data);
         }
@@ -18,9 +311,28 @@ namespace ed25519{
             return DecodeBase58Check(str, data);
         }
 
+        uint_least32_t crc32(const unsigned char *buf, size_t len) {
+            return crc32_update(0, buf, len);
+        }
+
         bool validate(const std::string &str) {
-            return Base58Check(str);
+            // keys, digests and signatures take the fixed-size decoders
+            return validate<size::hash>(str) || validate<size::double_hash>(str) || Base58Check(str);
+        }
+    }
+
+    std::string decode_error::message() const {
+        if (code == error::UNEXPECTED_SIZE) {
+            std::stringstream errorMessage;
+            errorMessage << "size of decoded vector is not equal to expected size: ";
+            if (size == SIZE_MAX)
+                errorMessage << "more than 256";
+            else
+                errorMessage << size;
+            errorMessage << " <> " << expected_size;
+            return errorMessage.str();
         }
+        return error_category().message(code);
     }
 
     error_category::error_category(const std::string &message):mess_(message) {}
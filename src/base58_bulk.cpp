@@ -0,0 +1,280 @@
+//
+// Bulk base58 codec for key registries: many items in one buffer, on several threads
+//
+
+#include "ed25519.hpp"
+#include "thread_ranges.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ed25519 {
+
+    namespace base58 {
+
+        namespace {
+
+            /* items converted per thread before spawning another one is worth it */
+            constexpr size_t items_per_thread = 1024;
+
+            /* items written to or bytes read from a file descriptor at once */
+            constexpr size_t stream_items = 64 * 1024;
+            constexpr size_t stream_bytes = 4 * 1024 * 1024;
+
+            size_t worker_count(size_t threads, size_t count) {
+              return thread_ranges::worker_count(threads, count, items_per_thread);
+            }
+
+            template<size_t N>
+            void append_fixed(const unsigned char *item, std::string &out) {
+              std::array<unsigned char, N> data;
+              std::copy_n(item, N, data.begin());
+              auto encoded = encode_fixed(data);
+              out.append(encoded.data(), encoded.size());
+            }
+
+            void append_encoded(const unsigned char *item, size_t size, std::string &out) {
+              if (size == size::hash)
+                return append_fixed<size::hash>(item, out);
+              if (size == size::double_hash)
+                return append_fixed<size::double_hash>(item, out);
+
+              std::vector<unsigned char> vch(item, item + size);
+              uint_least32_t crc32_ = crc32(vch.data(), vch.size());
+
+              // little endian
+              vch.push_back(static_cast<unsigned char>(crc32_ & 0xff));
+              vch.push_back(static_cast<unsigned char>((crc32_ >> 8) & 0xff));
+              vch.push_back(static_cast<unsigned char>((crc32_ >> 16) & 0xff));
+              vch.push_back(static_cast<unsigned char>((crc32_ >> 24) & 0xff));
+
+              out += encode(vch);
+            }
+
+            template<size_t N>
+            bool decode_fixed_to(std::string_view line, unsigned char *out) {
+              std::array<unsigned char, N> data;
+              if (!decode_fixed(line, data))
+                return false;
+              std::copy_n(data.begin(), N, out);
+              return true;
+            }
+
+            bool decode_line(std::string_view line, size_t size, unsigned char *out) {
+              if (size == size::hash)
+                return decode_fixed_to<size::hash>(line, out);
+              if (size == size::double_hash)
+                return decode_fixed_to<size::double_hash>(line, out);
+
+              std::vector<unsigned char> v;
+              if (!decode(std::string(line), v) || v.size() != size)
+                return false;
+              std::copy_n(v.begin(), size, out);
+              return true;
+            }
+
+            void report_line(std::string_view line, size_t size, size_t number, const ErrorHandler &error) {
+              std::stringstream errorMessage;
+              errorMessage << "line " << number << ": ";
+
+              std::vector<unsigned char> v;
+              if (!decode(std::string(line), v)) {
+                errorMessage << "base58 check string decode error";
+                error_category category(errorMessage.str());
+                std::error_code ec(static_cast<int>(error::BADFORMAT), category);
+                error(ec);
+              }
+              else {
+                errorMessage << "size of decoded vector is not equal to expected size: " << v.size() << " <> " << size;
+                error_category category(errorMessage.str());
+                std::error_code ec(static_cast<int>(error::UNEXPECTED_SIZE), category);
+                error(ec);
+              }
+            }
+
+            /* first_line is the number of lines preceding text, it is used in error messages only */
+            bool decode_lines(std::string_view text, size_t size, unsigned char *data, size_t count,
+                              size_t threads, size_t first_line, const ErrorHandler &error) {
+
+              // line i is [starts[i], starts[i + 1] - 1), a last line without '\n' ends at text.size()
+              std::vector<size_t> starts;
+              starts.reserve(count + 1);
+              starts.push_back(0);
+              for (size_t i = 0; i < count; ++i) {
+                auto end = text.find('\n', starts.back());
+                starts.push_back(end == std::string_view::npos ? text.size() + 1 : end + 1);
+              }
+
+              std::atomic<size_t> failed(count);
+
+              thread_ranges::run_ranges(count, worker_count(threads, count), [&](size_t first, size_t last) {
+                  for (size_t i = first; i < last; ++i) {
+                    auto line = text.substr(starts[i], starts[i + 1] - starts[i] - 1);
+                    if (!decode_line(line, size, data + i * size)) {
+                      size_t current = failed.load();
+                      while (i < current && !failed.compare_exchange_weak(current, i)) {}
+                      return;
+                    }
+                  }
+              });
+
+              if (failed.load() < count) {
+                size_t i = failed.load();
+                report_line(text.substr(starts[i], starts[i + 1] - starts[i] - 1), size, first_line + i + 1, error);
+                return false;
+              }
+
+              return true;
+            }
+
+            void report_errno(const ErrorHandler &error) {
+              std::error_code ec(errno, std::generic_category());
+              error(ec);
+            }
+
+            bool write_all(int fd, const char *buffer, size_t size, const ErrorHandler &error) {
+              while (size > 0) {
+#ifdef _WIN32
+                auto written = _write(fd, buffer, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+#else
+                auto written = ::write(fd, buffer, size);
+#endif
+                if (written < 0) {
+                  if (errno == EINTR) continue;
+                  report_errno(error);
+                  return false;
+                }
+                buffer += written;
+                size -= static_cast<size_t>(written);
+              }
+              return true;
+            }
+        }
+
+        encoded_list encode_bulk(const unsigned char *first, size_t stride, size_t count, size_t size,
+                                 size_t threads) {
+
+          encoded_list list;
+          list.offsets.resize(count + 1);
+          if (count == 0) return list;
+
+          threads = worker_count(threads, count);
+          size_t step = thread_ranges::range_size(count, threads);
+
+          // every range is encoded into its own buffer with offsets relative to it
+          std::vector<std::string> parts((count + step - 1) / step);
+
+          thread_ranges::run_ranges(count, threads, [&](size_t from, size_t to) {
+              auto &part = parts[from / step];
+              part.reserve((to - from) * (size * 138 / 100 + 8));
+              for (size_t i = from; i < to; ++i) {
+                append_encoded(first + i * stride, size, part);
+                part.push_back('\n');
+                list.offsets[i + 1] = part.size();
+              }
+          });
+
+          if (parts.size() == 1) {
+            list.buffer = std::move(parts.front());
+            return list;
+          }
+
+          size_t total = 0;
+          for (auto &part: parts) total += part.size();
+          list.buffer.reserve(total);
+
+          for (size_t k = 0; k < parts.size(); ++k) {
+            size_t base = list.buffer.size();
+            for (size_t i = k * step; i < std::min(count, (k + 1) * step); ++i)
+              list.offsets[i + 1] += base;
+            list.buffer += parts[k];
+          }
+
+          return list;
+        }
+
+        size_t count_lines(std::string_view text) {
+          if (text.empty()) return 0;
+          size_t lines = static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+          return text.back() == '\n' ? lines : lines + 1;
+        }
+
+        bool decode_bulk(std::string_view text, size_t size, unsigned char *data, size_t count,
+                         size_t threads, const ErrorHandler &error) {
+          auto lines = count_lines(text);
+          if (count != lines) {
+            std::stringstream errorMessage;
+            errorMessage << "number of lines is not equal to expected count: " << lines << " <> " << count;
+            error_category category(errorMessage.str());
+            std::error_code ec(static_cast<int>(error::UNEXPECTED_SIZE), category);
+            error(ec);
+            return false;
+          }
+          return decode_lines(text, size, data, count, threads, 0, error);
+        }
+
+        bool write_bulk(int fd, const unsigned char *first, size_t stride, size_t count, size_t size,
+                        size_t threads, const ErrorHandler &error) {
+          for (size_t i = 0; i < count; i += stream_items) {
+            auto list = encode_bulk(first + i * stride, stride, std::min(stream_items, count - i), size, threads);
+            if (!write_all(fd, list.buffer.data(), list.buffer.size(), error))
+              return false;
+          }
+          return true;
+        }
+
+        bool read_bulk(int fd, size_t size, const std::function<void(const unsigned char *items, size_t count)> &handler,
+                       size_t threads, const ErrorHandler &error) {
+
+          std::string pending;
+          std::vector<unsigned char> items;
+          size_t lines = 0;
+          bool eof = false;
+
+          while (!eof) {
+            size_t used = pending.size();
+            pending.resize(used + stream_bytes);
+#ifdef _WIN32
+            auto got = _read(fd, &pending[used], static_cast<unsigned>(stream_bytes));
+#else
+            auto got = ::read(fd, &pending[used], stream_bytes);
+#endif
+            if (got < 0) {
+              pending.resize(used);
+              if (errno == EINTR) continue;
+              report_errno(error);
+              return false;
+            }
+            pending.resize(used + static_cast<size_t>(got));
+            eof = got == 0;
+
+            // complete lines only, the rest waits for the next block unless the file ends
+            size_t end = pending.size();
+            if (!eof) {
+              auto last = pending.rfind('\n');
+              if (last == std::string::npos) continue;
+              end = last + 1;
+            }
+
+            std::string_view text(pending.data(), end);
+            size_t count = count_lines(text);
+            if (count > 0) {
+              items.resize(count * size);
+              if (!decode_lines(text, size, items.data(), count, threads, lines, error))
+                return false;
+              handler(items.data(), count);
+              lines += count;
+            }
+            pending.erase(0, end);
+          }
+
+          return true;
+        }
+    }
+}
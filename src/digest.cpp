@@ -5,56 +5,155 @@
 #include "ed25519.h"
 #include "ed25519.hpp"
 #include "sha3.hpp"
+#include "sha3_lanes.hpp"
+#include "blake3.hpp"
 #include "ed25519_ext.hpp"
 #include <iostream>
-
-#include <algorithm>
-
-template <typename T>
-constexpr T htonT (T value) noexcept
-{
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-  char* ptr = reinterpret_cast<char*>(&value);
-  std::reverse(ptr, ptr + sizeof(T));
-#endif
-  return value;
-}
+#include <new>
 
 namespace ed25519 {
 
 
-    struct CalculatorImpl: public Digest::Calculator{
+    struct CalculatorBase: public Digest::Calculator{
 
-        void append(const variant_t &value) override;
         void set_endian(endian) override ;
         endian get_endian() override ;
 
-        explicit CalculatorImpl(Digest *digest): ctx_({}), digest_(digest), endian_(little){
+        CalculatorBase(): endian_(host_endian){}
+
+    private:
+        Digest::Calculator::endian endian_;
+    };
+
+    struct CalculatorImpl: public CalculatorBase{
 
-            if ( htonT(47) == /* DISABLES CODE */ (47) ) {
-                endian_ = big;
-            } else {
-                endian_ = little;
-            }
+        explicit CalculatorImpl(Digest *digest): state_(), digest_(digest){}
 
-            sha3_Init256(&ctx_);
+        CalculatorImpl(Digest *digest, const Digest::State &state, endian e): state_(state), digest_(digest){
+            set_endian(e);
         }
 
         ~CalculatorImpl() {
-            sha3_Finalize(&ctx_, digest_->data());
+            state_.finalize(*digest_);
+        }
+
+    protected:
+        void update(const void *data, size_t size) override {
+            state_.update(data, size);
         }
 
     private:
-        sha3_context ctx_;
+        Digest::State state_;
         Digest *digest_;
-        Digest::Calculator::endian endian_;
+    };
+
+    struct Blake3CalculatorImpl: public CalculatorBase{
 
+        explicit Blake3CalculatorImpl(Digest *digest): digest_(digest){
+            blake3_hasher_init(&hasher_);
+        }
+
+        ~Blake3CalculatorImpl() {
+            blake3_hasher_finalize(&hasher_, digest_->data(), digest_->size());
+        }
+
+    protected:
+        void update(const void *data, size_t size) override {
+            blake3_hasher_update(&hasher_, data, size);
+        }
+
+    private:
+        blake3_hasher hasher_;
+        Digest *digest_;
     };
 
+    /**
+     * Absorbs into an external state, the endianness is written back when done
+     */
+    struct PrefixImpl: public CalculatorBase{
+
+        PrefixImpl(Digest::State &state, endian &e): state_(state), endian_(e){
+            set_endian(e);
+        }
+
+        ~PrefixImpl() {
+            endian_ = get_endian();
+        }
+
+    protected:
+        void update(const void *data, size_t size) override {
+            state_.update(data, size);
+        }
+
+    private:
+        Digest::State &state_;
+        endian &endian_;
+    };
+
+    /**
+     * Collects the byte stream of a record instead of hashing it,
+     * so Digest::Bulk can hash many records in parallel lanes
+     */
+    struct RecorderImpl: public CalculatorBase{
+
+        explicit RecorderImpl(std::vector<unsigned char> &buffer): buffer_(buffer){}
+
+    protected:
+        void update(const void *data, size_t size) override {
+            auto bytes = static_cast<const unsigned char *>(data);
+            buffer_.insert(buffer_.end(), bytes, bytes + size);
+        }
+
+    private:
+        std::vector<unsigned char> &buffer_;
+    };
+
+    static_assert(sizeof(sha3_context) <= sizeof(Digest::State) && alignof(sha3_context) <= alignof(Digest::State),
+                  "Digest::State is too small for sha3_context");
+
+    Digest::State::State() {
+        sha3_Init256(new (context_) sha3_context);
+    }
+
+    void Digest::State::update(const void *data, size_t size) {
+        sha3_Update(context_, data, size);
+    }
+
+    void Digest::State::finalize(Digest &digest) {
+        sha3_Finalize(context_, digest.data());
+    }
 
     Digest::Digest(const context& handler):Data<size::digest>() {
-        CalculatorImpl calculator(this);
-        handler(calculator);
+        calculate(&invoke<const context &>, pointer_of(handler));
+    }
+
+    Digest::Digest(const context& handler, algorithm hash):Data<size::digest>() {
+        calculate(&invoke<const context &>, pointer_of(handler), hash);
+    }
+
+    void Digest::calculate(void (*invoke)(void *handler, Calculator &calculator), void *handler,
+                           algorithm hash) {
+        if (hash == blake3) {
+            Blake3CalculatorImpl calculator(this);
+            invoke(handler, calculator);
+        }
+        else {
+            CalculatorImpl calculator(this);
+            invoke(handler, calculator);
+        }
+    }
+
+    Digest Digest::Blake3(const unsigned char *data, size_t size, size_t threads) {
+        blake3_hasher hasher;
+        blake3_hasher_init(&hasher);
+        blake3_hasher_update_parallel(&hasher, data, size, threads);
+        Digest digest;
+        blake3_hasher_finalize(&hasher, digest.data(), digest.size());
+        return digest;
+    }
+
+    Digest Digest::Blake3(const std::vector<unsigned char> &data, size_t threads) {
+        return Blake3(data.data(), data.size(), threads);
     }
 
     Digest::Digest():Data<size::digest>() {}
@@ -67,83 +166,153 @@ namespace ed25519 {
         return std::nullopt;
     }
 
-    void CalculatorImpl::set_endian(Digest::Calculator::endian e) {
+    expected<Digest> Digest::TryDecode(std::string_view base58) {
+        auto s = Digest();
+        decode_error failure{};
+        if (base58::try_decode(base58, s.data(), s.size(), failure)){
+            return s;
+        }
+        return failure;
+    }
+
+    std::optional<Digest> Digest::FromHex(std::string_view hex, const ed25519::ErrorHandler &error) {
+        auto s = Digest();
+        if (s.from_hex(hex,error)){
+            return std::make_optional(s);
+        }
+        return std::nullopt;
+    }
+
+    Digest::Prefix::Prefix(const context &handler) {
+        absorb(&invoke<const context &>, pointer_of(handler));
+    }
+
+    void Digest::Prefix::absorb(void (*invoke)(void *handler, Calculator &calculator), void *handler) {
+        PrefixImpl calculator(state_, endian_);
+        invoke(handler, calculator);
+    }
+
+    Digest Digest::Prefix::finish(const context &handler) const {
+        return calculate(&invoke<const context &>, pointer_of(handler));
+    }
+
+    Digest Digest::Prefix::finish() const {
+        Digest digest;
+        auto state = state_;
+        state.finalize(digest);
+        return digest;
+    }
+
+    Digest Digest::Prefix::calculate(void (*invoke)(void *handler, Calculator &calculator), void *handler) const {
+        Digest digest;
+        {
+            CalculatorImpl calculator(&digest, state_, endian_);
+            invoke(handler, calculator);
+        }
+        return digest;
+    }
+
+    std::vector<Digest> Digest::Bulk(const std::vector<context> &handlers) {
+
+        std::vector<unsigned char> buffer;
+        std::vector<size_t> offsets;
+        offsets.reserve(handlers.size() + 1);
+        offsets.push_back(0);
+
+        for (auto &handler: handlers) {
+            RecorderImpl recorder(buffer);
+            handler(recorder);
+            offsets.push_back(buffer.size());
+        }
+
+        std::vector<Digest> digests(handlers.size());
+        std::vector<const unsigned char *> messages(handlers.size());
+        std::vector<size_t> sizes(handlers.size());
+        std::vector<unsigned char *> out(handlers.size());
+
+        for (size_t i = 0; i < handlers.size(); ++i) {
+            messages[i] = buffer.data() + offsets[i];
+            sizes[i] = offsets[i + 1] - offsets[i];
+            out[i] = digests[i].data();
+        }
+
+        sha3_256_lanes(messages.data(), sizes.data(), handlers.size(), out.data());
+
+        return digests;
+    }
+
+    void CalculatorBase::set_endian(Digest::Calculator::endian e) {
         endian_ = e;
     }
 
-    Digest::Calculator::endian CalculatorImpl::get_endian() {
+    Digest::Calculator::endian CalculatorBase::get_endian() {
         return endian_;
     }
 
-    void CalculatorImpl::append(const Digest::Calculator::variant_t &value) {
-
-        ed25519::visit([&](auto&& arg) {
-
-            using T = std::decay_t<decltype(arg)>;
-
-            if constexpr (std::is_same_v<T, bool>){
-                unsigned char data = arg ? 1 : 0;
-                sha3_Update((void *)&ctx_, &data, 1);
-            }
-
-            else if constexpr (std::is_same_v<T, unsigned char>){
-                unsigned char data = arg;
-                sha3_Update((void *)&ctx_, &data, 1);
-            }
-
-            else if constexpr (std::is_same_v<T, short int>){
-                std::vector<unsigned char> message;
-                if (endian_ == little)
-                {
-                    message.push_back(static_cast<unsigned char>(arg & 0xff));
-                    message.push_back(static_cast<unsigned char>((arg >> 8) & 0xff));
-                }
-                else
-                {
-                    message.push_back(static_cast<unsigned char>((arg >> 8) & 0xff));
-                    message.push_back(static_cast<unsigned char>(arg & 0xff));
-                }
-                sha3_Update(&ctx_, message.data(), message.size());
-            }
-
-            else if constexpr (std::is_same_v<T, int>){
-                std::vector<unsigned char> message;
-
-                if (endian_ == little)
-                {
-                    message.push_back(static_cast<unsigned char>(arg & 0xff));
-                    message.push_back(static_cast<unsigned char>((arg >> 8) & 0xff));
-                    message.push_back(static_cast<unsigned char>((arg >> 16) & 0xff));
-                    message.push_back(static_cast<unsigned char>((arg >> 24) & 0xff));
-                }
-                else
-                {
-                    message.push_back(static_cast<unsigned char>((arg >> 24) & 0xff));
-                    message.push_back(static_cast<unsigned char>((arg >> 16) & 0xff));
-                    message.push_back(static_cast<unsigned char>((arg >> 8) & 0xff));
-                    message.push_back(static_cast<unsigned char>(arg & 0xff));
-                }
-                sha3_Update(&ctx_, message.data(), message.size());
-            }
-
-            else if constexpr (std::is_same_v<T, std::string>){
-                sha3_Update(&ctx_, arg.data(), arg.size());
-            }
-
-            else if constexpr (std::is_same_v<T, std::vector<unsigned char>>){
-                sha3_Update(&ctx_, arg.data(), arg.size());
-            }
-
-            else if constexpr (std::is_same_v<T, Data<size::hash>>){
-                sha3_Update(&ctx_, arg.data(), arg.size());
-            }
-
-            else if constexpr (std::is_same_v<T, Data<size::double_hash>>){
-                sha3_Update(&ctx_, arg.data(), arg.size());
-            }
-
-
-        }, value);
+    void Digest::Calculator::append(const Digest::Calculator::variant_t &value) {
+        ed25519::visit([this](auto&& arg) { append(arg); }, value);
+    }
+
+    void Digest::Calculator::append(bool value) {
+        unsigned char data = value ? 1 : 0;
+        update(&data, 1);
+    }
+
+    void Digest::Calculator::append(unsigned char value) {
+        update(&value, 1);
+    }
+
+    void Digest::Calculator::append(short int value) {
+        unsigned char data[2];
+        if (get_endian() == little)
+        {
+            data[0] = static_cast<unsigned char>(value & 0xff);
+            data[1] = static_cast<unsigned char>((value >> 8) & 0xff);
+        }
+        else
+        {
+            data[0] = static_cast<unsigned char>((value >> 8) & 0xff);
+            data[1] = static_cast<unsigned char>(value & 0xff);
+        }
+        update(data, sizeof(data));
+    }
+
+    void Digest::Calculator::append(int value) {
+        unsigned char data[4];
+        if (get_endian() == little)
+        {
+            data[0] = static_cast<unsigned char>(value & 0xff);
+            data[1] = static_cast<unsigned char>((value >> 8) & 0xff);
+            data[2] = static_cast<unsigned char>((value >> 16) & 0xff);
+            data[3] = static_cast<unsigned char>((value >> 24) & 0xff);
+        }
+        else
+        {
+            data[0] = static_cast<unsigned char>((value >> 24) & 0xff);
+            data[1] = static_cast<unsigned char>((value >> 16) & 0xff);
+            data[2] = static_cast<unsigned char>((value >> 8) & 0xff);
+            data[3] = static_cast<unsigned char>(value & 0xff);
+        }
+        update(data, sizeof(data));
+    }
+
+    void Digest::Calculator::append(std::string_view value) {
+        update(value.data(), value.size());
+    }
+
+    void Digest::Calculator::append(const std::string &value) {
+        update(value.data(), value.size());
+    }
+
+    void Digest::Calculator::append(const std::vector<unsigned char> &value) {
+        update(value.data(), value.size());
+    }
+
+    void Digest::Calculator::append(const Data<size::hash> &value) {
+        update(value.data(), value.size());
+    }
 
+    void Digest::Calculator::append(const Data<size::double_hash> &value) {
+        update(value.data(), value.size());
     }
 }
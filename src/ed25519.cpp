@@ -6,8 +6,11 @@
 #include "ed25519.hpp"
 #include "sha3.hpp"
 #include "ed25519_ext.hpp"
+#include "csprng.hpp"
+#include "verify_cache.hpp"
 #include <iostream>
 #include <memory>
+#include <new>
 
 namespace ed25519 {
 
@@ -18,7 +21,10 @@ namespace ed25519 {
 
     Seed::Seed():seed_data() {
         fill(0);
-        ed25519_create_seed(this->data());
+        // a zero seed would give every caller the same key
+        if (csprng_bytes(this->data(), size::seed) != 0)
+            throw std::system_error(std::make_error_code(std::errc::io_error),
+                                    "system random source is unavailable");
     }
 
     namespace keys {
@@ -31,6 +37,23 @@ namespace ed25519 {
             return std::nullopt;
         }
 
+        expected<Public> Public::TryDecode(std::string_view base58){
+            auto s = Public();
+            decode_error failure{};
+            if (base58::try_decode(base58, s.data(), s.size(), failure)){
+                return s;
+            }
+            return failure;
+        }
+
+        std::optional<Public> Public::FromHex(std::string_view hex, const ErrorHandler &error){
+            auto s = Public();
+            if (s.from_hex(hex,error)){
+                return std::make_optional(s);
+            }
+            return std::nullopt;
+        }
+
         std::optional<Private> Private::Decode(const std::string &base58, const ErrorHandler &error){
             auto s = Private();
             if (s.decode(base58,error)){
@@ -39,6 +62,35 @@ namespace ed25519 {
             return std::nullopt;
         }
 
+        expected<Private> Private::TryDecode(std::string_view base58){
+            auto s = Private();
+            decode_error failure{};
+            if (base58::try_decode(base58, s.data(), s.size(), failure)){
+                return s;
+            }
+            return failure;
+        }
+
+        bool Public::validate() const {
+            return ed25519_public_key_is_valid(data()) == 1;
+        }
+
+        std::optional<Public> Public::derive(const Tweak &tweak) const {
+            auto parent = PreparedParent::Prepare(*this);
+            if (!parent) {
+                return std::nullopt;
+            }
+            return parent->derive(tweak);
+        }
+
+        bool Private::validate() const {
+            const unsigned char *scalar = data();
+
+            bool clamped = (scalar[0] & 7) == 0 && (scalar[31] & 192) == 64;
+
+            return clamped || ed25519_scalar_is_canonical(scalar) == 1;
+        }
+
         Pair::Pair() {
             clean();
         }
@@ -47,7 +99,10 @@ namespace ed25519 {
 
             Pair pair;
 
-            Seed seed;
+            std::array<unsigned char, size::seed> seed{};
+            if (csprng_bytes(seed.data(), seed.size()) != 0)
+                return std::nullopt;
+
             ed25519_create_keypair(pair.publicKey_.data(), pair.privateKey_.data(), seed.data());
             return std::make_optional(pair);
         }
@@ -56,7 +111,8 @@ namespace ed25519 {
 
             if (privateKey.empty())
             {
-                std::error_code ec(static_cast<int>(error::EMPTY),error_category("private keyis empty"));
+                error_category category("private keyis empty");
+                std::error_code ec(static_cast<int>(error::EMPTY),category);
                 error(ec);
                 return std::nullopt;
             }
@@ -77,7 +133,8 @@ namespace ed25519 {
                                              const ed25519::ErrorHandler &error) {
             if (phrase.empty())
             {
-                std::error_code ec(static_cast<int>(error::EMPTY),error_category("secret phrase is empty"));
+                error_category category("secret phrase is empty");
+                std::error_code ec(static_cast<int>(error::EMPTY),category);
                 error(ec);
                 return std::nullopt;
             }
@@ -94,8 +151,13 @@ namespace ed25519 {
             privateKey_.clean();
         }
 
-        bool Pair::validate() {
-            return publicKey_.validate() && privateKey_.validate();
+        bool Pair::validate() const {
+            if (!publicKey_.validate() || !privateKey_.validate())
+                return false;
+
+            Public restored;
+            ed25519_restore_from_private_key(restored.data(), privateKey_.data());
+            return restored == publicKey_;
         }
 
         std::unique_ptr<Signature> Pair::sign(const std::vector<unsigned char>& message){
@@ -110,9 +172,16 @@ namespace ed25519 {
             return signature;
         }
 
-        std::unique_ptr<Signature> Pair::sign(const std::string &message){
-            std::vector<unsigned char> v(message.begin(), message.end());
-            return sign(v);
+        std::unique_ptr<Signature> Pair::sign(std::string_view message){
+
+            auto signature = std::unique_ptr<Signature>{new Signature()};
+
+            ed25519_sign(signature->data(),
+                         reinterpret_cast<const unsigned char *>(message.data()), message.size(),
+                         publicKey_.data(),
+                         privateKey_.data());
+
+            return signature;
         }
 
         std::unique_ptr<Signature> Pair::sign(const Digest& digest){
@@ -126,6 +195,198 @@ namespace ed25519 {
 
             return signature;
         }
+
+        pmr::unique_ptr<Signature> Pair::sign(const std::vector<unsigned char>& message,
+                                              std::pmr::memory_resource *resource){
+            return sign(std::string_view(reinterpret_cast<const char *>(message.data()), message.size()), resource);
+        }
+
+        pmr::unique_ptr<Signature> Pair::sign(std::string_view message, std::pmr::memory_resource *resource){
+
+            auto memory = resource->allocate(sizeof(Signature), alignof(Signature));
+            auto signature = pmr::unique_ptr<Signature>{new (memory) Signature(), pmr::deleter<Signature>{resource}};
+
+            ed25519_sign(signature->data(),
+                         reinterpret_cast<const unsigned char *>(message.data()), message.size(),
+                         publicKey_.data(),
+                         privateKey_.data());
+
+            return signature;
+        }
+
+        pmr::unique_ptr<Signature> Pair::sign(const Digest& digest, std::pmr::memory_resource *resource){
+            return sign(std::string_view(reinterpret_cast<const char *>(digest.data()), digest.size()), resource);
+        }
+
+        SignatureBytes Pair::sign_bytes(std::string_view message) const {
+            SignatureBytes signature;
+
+            ed25519_sign(signature.data(),
+                         reinterpret_cast<const unsigned char *>(message.data()), message.size(),
+                         publicKey_.data(),
+                         privateKey_.data());
+
+            return signature;
+        }
+
+        SignatureBytes Pair::sign_bytes(const std::vector<unsigned char> &message) const {
+            return sign_bytes(std::string_view(reinterpret_cast<const char *>(message.data()), message.size()));
+        }
+
+        SignatureBytes Pair::sign_bytes(const DigestBytes &digest) const {
+            return sign_bytes(std::string_view(reinterpret_cast<const char *>(digest.data()), digest.size()));
+        }
+
+        Pair Pair::derive(const Tweak &tweak) const {
+            Pair child(*this);
+            ed25519_add_scalar(child.publicKey_.data(), child.privateKey_.data(), tweak.data());
+            return child;
+        }
+
+        SharedSecret Pair::exchange(const Public &peer) const {
+            SharedSecret secret;
+            ed25519_key_exchange(secret.data(), peer.data(), privateKey_.data());
+            return secret;
+        }
+
+        SharedSecret Pair::exchange(const PublicKeyBytes &peer) const {
+            SharedSecret secret;
+            ed25519_key_exchange(secret.data(), peer.data(), privateKey_.data());
+            return secret;
+        }
+
+        SharedSecret Pair::exchange(const PreparedPeer &peer) const {
+            return exchange(peer.get_exchange_key());
+        }
+
+        SharedSecret Pair::exchange(const ExchangeKey &peer) const {
+            SharedSecret secret;
+            ed25519_x25519(secret.data(), peer.data(), privateKey_.data());
+            return secret;
+        }
+
+        Ephemeral::Ephemeral() {
+            clean();
+        }
+
+        std::optional<Ephemeral> Ephemeral::Random() {
+
+            Ephemeral ephemeral;
+
+            // a zero scalar would give every caller the same key
+            if (csprng_bytes(ephemeral.privateKey_.data(), ephemeral.privateKey_.size()) != 0)
+                return std::nullopt;
+
+            ed25519_x25519_public_key(ephemeral.publicKey_.data(), ephemeral.privateKey_.data());
+            return std::make_optional(ephemeral);
+        }
+
+        std::optional<Ephemeral> Ephemeral::FromPrivateKey(const std::string &privateKey, const ErrorHandler &error) {
+
+            if (privateKey.empty())
+            {
+                error_category category("private key is empty");
+                std::error_code ec(static_cast<int>(error::EMPTY),category);
+                error(ec);
+                return std::nullopt;
+            }
+
+            Ephemeral ephemeral;
+
+            if (!ephemeral.privateKey_.decode(privateKey, error))
+            {
+                return std::nullopt;
+            }
+
+            ed25519_x25519_public_key(ephemeral.publicKey_.data(), ephemeral.privateKey_.data());
+            return std::make_optional(ephemeral);
+        }
+
+        SharedSecret Ephemeral::exchange(const ExchangeKey &peer) const {
+            SharedSecret secret;
+            ed25519_x25519(secret.data(), peer.data(), privateKey_.data());
+            return secret;
+        }
+
+        SharedSecret Ephemeral::exchange(const Public &peer) const {
+            SharedSecret secret;
+            ed25519_key_exchange(secret.data(), peer.data(), privateKey_.data());
+            return secret;
+        }
+
+        SharedSecret Ephemeral::exchange(const PublicKeyBytes &peer) const {
+            SharedSecret secret;
+            ed25519_key_exchange(secret.data(), peer.data(), privateKey_.data());
+            return secret;
+        }
+
+        void Ephemeral::clean() {
+            publicKey_.clean();
+            privateKey_.clean();
+        }
+
+        PreparedPeer::PreparedPeer(const Public &peer): publicKey_(peer) {
+            ed25519_public_key_to_x25519(exchangeKey_.data(), peer.data());
+        }
+
+        PreparedPeer::PreparedPeer(const PublicKeyBytes &peer): publicKey_(peer) {
+            ed25519_public_key_to_x25519(exchangeKey_.data(), peer.data());
+        }
+
+        template<typename Key>
+        std::vector<PreparedPeer> PreparedPeer::prepare(const std::vector<Key> &peers) {
+
+            std::vector<PreparedPeer> prepared(peers.size(), PreparedPeer());
+
+            constexpr size_t batch = ED25519_X25519_BATCH;
+            unsigned char public_keys[batch * size::public_key];
+            unsigned char exchange_keys[batch * size::exchange_key];
+
+            for (size_t from = 0; from < peers.size(); from += batch) {
+                size_t n = std::min(batch, peers.size() - from);
+
+                for (size_t i = 0; i < n; ++i)
+                    std::copy_n(peers[from + i].data(), size::public_key, public_keys + i * size::public_key);
+
+                ed25519_public_keys_to_x25519(exchange_keys, public_keys, n);
+
+                for (size_t i = 0; i < n; ++i) {
+                    auto &peer = prepared[from + i];
+                    peer.publicKey_ = Public(peers[from + i]);
+                    std::copy_n(exchange_keys + i * size::exchange_key, size::exchange_key, peer.exchangeKey_.data());
+                }
+            }
+
+            return prepared;
+        }
+
+        std::vector<PreparedPeer> PreparedPeer::Prepare(const std::vector<Public> &peers) {
+            return prepare(peers);
+        }
+
+        std::vector<PreparedPeer> PreparedPeer::PrepareBytes(const std::vector<PublicKeyBytes> &peers) {
+            return prepare(peers);
+        }
+    }
+
+    namespace {
+
+        bool verify_cached(const unsigned char *signature, const unsigned char *message, size_t len,
+                           const unsigned char *public_key) {
+
+            unsigned char tag[VERIFY_CACHE_TAG_SIZE];
+            int cached = verify_cache_lookup(tag, signature, public_key, message, len);
+
+            if (cached == 1)
+                return true;
+
+            bool verified = ed25519_verify(signature, message, len, public_key) == 1;
+
+            if (verified && cached == 0)
+                verify_cache_insert(tag);
+
+            return verified;
+        }
     }
 
     std::optional<Signature> Signature::Decode(const std::string &base58, const ErrorHandler &error){
@@ -136,17 +397,54 @@ namespace ed25519 {
         return std::nullopt;
     }
 
+    expected<Signature> Signature::TryDecode(std::string_view base58){
+        auto s = Signature();
+        decode_error failure{};
+        if (base58::try_decode(base58, s.data(), s.size(), failure)){
+            return s;
+        }
+        return failure;
+    }
+
+    std::optional<Signature> Signature::FromHex(std::string_view hex, const ErrorHandler &error){
+        auto s = Signature();
+        if (s.from_hex(hex,error)){
+            return std::make_optional(s);
+        }
+        return std::nullopt;
+    }
+
+    bool Signature::validate() const {
+        return ed25519_scalar_is_canonical(data() + size::hash) == 1;
+    }
+
     bool Signature::verify(const ed25519::Digest &digest, const ed25519::keys::Public &key) const {
-        return ed25519_verify(data(), digest.data(), digest.size(), key.data()) == 1;
+        return verify_cached(data(), digest.data(), digest.size(), key.data());
     }
 
-    bool Signature::verify(const std::string &message, const ed25519::keys::Public &key) const {
-        std::vector<unsigned char> v(message.begin(), message.end());
-        return verify(v,key);
+    bool Signature::verify(std::string_view message, const ed25519::keys::Public &key) const {
+        return verify_cached(data(), reinterpret_cast<const unsigned char *>(message.data()), message.size(), key.data());
     }
 
     bool Signature::verify(const std::vector<unsigned char> &message, const ed25519::keys::Public &key) const {
-        return ed25519_verify(data(), message.data(), message.size(), key.data()) == 1;
+        return verify_cached(data(), message.data(), message.size(), key.data());
+    }
+
+    bool Signature::verify(std::string_view message, const PublicKeyBytes &key) const {
+        return verify_cached(data(), reinterpret_cast<const unsigned char *>(message.data()), message.size(), key.data());
+    }
+
+    bool Signature::verify(const ed25519::Digest &digest, const PublicKeyBytes &key) const {
+        return verify_cached(data(), digest.data(), digest.size(), key.data());
+    }
+
+    bool verify(const SignatureBytes &signature, std::string_view message, const PublicKeyBytes &key) {
+        return verify_cached(signature.data(), reinterpret_cast<const unsigned char *>(message.data()), message.size(),
+                             key.data());
+    }
+
+    bool verify(const SignatureBytes &signature, const DigestBytes &digest, const PublicKeyBytes &key) {
+        return verify_cached(signature.data(), digest.data(), digest.size(), key.data());
     }
 
 }
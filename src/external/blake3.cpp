@@ -0,0 +1,544 @@
+//
+// BLAKE3 hash mode, after the reference implementation of the specification.
+//
+// The hasher keeps the current chunk and a stack of subtree chaining values.
+// A chunk is compressed as a non-root node only when more input follows it,
+// so the last chunk always stays in the hasher until finalize. Runs of full
+// chunks skip the per-block path: every lane of a SIMD register compresses a
+// different chunk, the chunk counter of a lane is its index in the input.
+//
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "blake3.hpp"
+#include "thread_ranges.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BLAKE3_X86 1
+#include <immintrin.h>
+#else
+#define BLAKE3_X86 0
+#endif
+
+/* chunks of a subtree hashed by one thread task: 64 KiB */
+#define BLAKE3_SUBTREE_CHUNKS 64
+#define BLAKE3_SUBTREE_LEN (BLAKE3_SUBTREE_CHUNKS * BLAKE3_CHUNK_LEN)
+/* subtrees hashed per thread before spawning another one is worth it */
+#define BLAKE3_SUBTREES_PER_THREAD 4
+
+enum blake3_flags {
+    CHUNK_START = 1 << 0,
+    CHUNK_END = 1 << 1,
+    PARENT = 1 << 2,
+    ROOT = 1 << 3
+};
+
+static const uint32_t blake3_iv[8] = {
+    0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL,
+    0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL
+};
+
+/* message word order of every round: the permutation applied r times */
+static const uint8_t blake3_schedule[7][16] = {
+    { 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15},
+    { 2,  6,  3, 10,  7,  0,  4, 13,  1, 11, 12,  5,  9, 14, 15,  8},
+    { 3,  4, 10, 12, 13,  2,  7, 14,  6,  5,  9,  0, 11, 15,  8,  1},
+    {10,  7, 12,  9, 14,  3, 13, 15,  4,  0, 11,  2,  5,  8,  1,  6},
+    {12, 13,  9, 11, 15, 10, 14,  8,  7,  2,  5,  3,  0,  1,  6,  4},
+    { 9, 14, 11,  5,  8, 12, 15,  1, 13,  3,  0, 10,  2,  6,  4,  7},
+    {11, 15,  5,  0,  1,  9,  8,  6, 14, 10,  2, 12,  3,  4,  7, 13}
+};
+
+typedef struct blake3_output_ {
+    uint32_t cv[8];
+    uint32_t m[16];
+    uint64_t counter;
+    uint32_t block_len;
+    uint32_t flags;
+} blake3_output;
+
+static inline uint32_t load32_le(const uint8_t *p) {
+    uint32_t t;
+    memcpy(&t, p, sizeof(t));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    t = __builtin_bswap32(t);
+#endif
+    return t;
+}
+
+static inline void store32_le(uint8_t *p, uint32_t t) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    t = __builtin_bswap32(t);
+#endif
+    memcpy(p, &t, sizeof(t));
+}
+
+static inline void load_block(const uint8_t *block, uint32_t m[16]) {
+    unsigned i;
+    for (i = 0; i < 16; i++)
+        m[i] = load32_le(block + 4 * i);
+}
+
+static inline uint32_t rotr32(uint32_t x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+#define BLAKE3_G(v, a, b, c, d, x, y) do { \
+    v[a] = v[a] + v[b] + (x); v[d] = rotr32(v[d] ^ v[a], 16); \
+    v[c] = v[c] + v[d];       v[b] = rotr32(v[b] ^ v[c], 12); \
+    v[a] = v[a] + v[b] + (y); v[d] = rotr32(v[d] ^ v[a], 8);  \
+    v[c] = v[c] + v[d];       v[b] = rotr32(v[b] ^ v[c], 7);  \
+} while (0)
+
+static void compress(const uint32_t cv[8], const uint32_t m[16],
+                     uint32_t block_len, uint64_t counter, uint32_t flags,
+                     uint32_t out[16]) {
+    uint32_t v[16];
+    unsigned i, r;
+
+    for (i = 0; i < 8; i++) v[i] = cv[i];
+    v[8] = blake3_iv[0]; v[9] = blake3_iv[1]; v[10] = blake3_iv[2]; v[11] = blake3_iv[3];
+    v[12] = (uint32_t) counter;
+    v[13] = (uint32_t) (counter >> 32);
+    v[14] = block_len;
+    v[15] = flags;
+
+    for (r = 0; r < 7; r++) {
+        const uint8_t *s = blake3_schedule[r];
+        BLAKE3_G(v, 0, 4,  8, 12, m[s[0]],  m[s[1]]);
+        BLAKE3_G(v, 1, 5,  9, 13, m[s[2]],  m[s[3]]);
+        BLAKE3_G(v, 2, 6, 10, 14, m[s[4]],  m[s[5]]);
+        BLAKE3_G(v, 3, 7, 11, 15, m[s[6]],  m[s[7]]);
+        BLAKE3_G(v, 0, 5, 10, 15, m[s[8]],  m[s[9]]);
+        BLAKE3_G(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+        BLAKE3_G(v, 2, 7,  8, 13, m[s[12]], m[s[13]]);
+        BLAKE3_G(v, 3, 4,  9, 14, m[s[14]], m[s[15]]);
+    }
+
+    for (i = 0; i < 8; i++) {
+        out[i] = v[i] ^ v[i + 8];
+        out[i + 8] = v[i + 8] ^ cv[i];
+    }
+}
+
+static void hash_chunk(const uint8_t *chunk, uint64_t counter, uint32_t out[8]) {
+    uint32_t m[16], state[16];
+    unsigned b;
+
+    memcpy(out, blake3_iv, sizeof(blake3_iv));
+    for (b = 0; b < BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN; b++) {
+        uint32_t flags = (b == 0 ? CHUNK_START : 0) |
+                         (b == BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN - 1 ? CHUNK_END : 0);
+        load_block(chunk + b * BLAKE3_BLOCK_LEN, m);
+        compress(out, m, BLAKE3_BLOCK_LEN, counter, flags, state);
+        memcpy(out, state, 8 * sizeof(uint32_t));
+    }
+}
+
+#if BLAKE3_X86
+
+/* GCC 12 reports its own _mm512_undefined_* placeholders as uninitialized */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+__attribute__((target("avx2")))
+static inline __m256i rotr16_x8(__m256i x) {
+    return _mm256_shuffle_epi8(x, _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                                  13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i rotr8_x8(__m256i x) {
+    return _mm256_shuffle_epi8(x, _mm256_set_epi8(12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1,
+                                                  12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1));
+}
+
+#define BLAKE3_G_X8(v, a, b, c, d, x, y) do { \
+    v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), x); \
+    v[d] = rotr16_x8(_mm256_xor_si256(v[d], v[a])); \
+    v[c] = _mm256_add_epi32(v[c], v[d]); \
+    v[b] = _mm256_xor_si256(v[b], v[c]); \
+    v[b] = _mm256_or_si256(_mm256_srli_epi32(v[b], 12), _mm256_slli_epi32(v[b], 20)); \
+    v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), y); \
+    v[d] = rotr8_x8(_mm256_xor_si256(v[d], v[a])); \
+    v[c] = _mm256_add_epi32(v[c], v[d]); \
+    v[b] = _mm256_xor_si256(v[b], v[c]); \
+    v[b] = _mm256_or_si256(_mm256_srli_epi32(v[b], 7), _mm256_slli_epi32(v[b], 25)); \
+} while (0)
+
+/* 8 consecutive chunks, lane j compresses input + j * BLAKE3_CHUNK_LEN */
+__attribute__((target("avx2")))
+static void hash_chunks_x8(const uint8_t *input, uint64_t counter, uint32_t out[][8]) {
+    const __m256i index = _mm256_setr_epi32(0, 256, 512, 768, 1024, 1280, 1536, 1792);
+    alignas(32) uint32_t lanes[8][8];
+    __m256i cv[8], m[16], v[16], counter_lo, counter_hi;
+    unsigned i, j, b, r;
+
+    for (j = 0; j < 8; j++) {
+        lanes[0][j] = (uint32_t) (counter + j);
+        lanes[1][j] = (uint32_t) ((counter + j) >> 32);
+    }
+    counter_lo = _mm256_load_si256((const __m256i *) lanes[0]);
+    counter_hi = _mm256_load_si256((const __m256i *) lanes[1]);
+
+    for (i = 0; i < 8; i++)
+        cv[i] = _mm256_set1_epi32((int) blake3_iv[i]);
+
+    for (b = 0; b < BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN; b++) {
+        uint32_t flags = (b == 0 ? CHUNK_START : 0) |
+                         (b == BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN - 1 ? CHUNK_END : 0);
+
+        for (i = 0; i < 16; i++)
+            m[i] = _mm256_i32gather_epi32((const int *) (input + b * BLAKE3_BLOCK_LEN + 4 * i), index, 4);
+
+        for (i = 0; i < 8; i++) v[i] = cv[i];
+        for (i = 0; i < 4; i++) v[i + 8] = _mm256_set1_epi32((int) blake3_iv[i]);
+        v[12] = counter_lo;
+        v[13] = counter_hi;
+        v[14] = _mm256_set1_epi32(BLAKE3_BLOCK_LEN);
+        v[15] = _mm256_set1_epi32((int) flags);
+
+        for (r = 0; r < 7; r++) {
+            const uint8_t *s = blake3_schedule[r];
+            BLAKE3_G_X8(v, 0, 4,  8, 12, m[s[0]],  m[s[1]]);
+            BLAKE3_G_X8(v, 1, 5,  9, 13, m[s[2]],  m[s[3]]);
+            BLAKE3_G_X8(v, 2, 6, 10, 14, m[s[4]],  m[s[5]]);
+            BLAKE3_G_X8(v, 3, 7, 11, 15, m[s[6]],  m[s[7]]);
+            BLAKE3_G_X8(v, 0, 5, 10, 15, m[s[8]],  m[s[9]]);
+            BLAKE3_G_X8(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+            BLAKE3_G_X8(v, 2, 7,  8, 13, m[s[12]], m[s[13]]);
+            BLAKE3_G_X8(v, 3, 4,  9, 14, m[s[14]], m[s[15]]);
+        }
+
+        for (i = 0; i < 8; i++)
+            cv[i] = _mm256_xor_si256(v[i], v[i + 8]);
+    }
+
+    for (i = 0; i < 8; i++)
+        _mm256_store_si256((__m256i *) lanes[i], cv[i]);
+    for (j = 0; j < 8; j++)
+        for (i = 0; i < 8; i++)
+            out[j][i] = lanes[i][j];
+}
+
+#define BLAKE3_G_X16(v, a, b, c, d, x, y) do { \
+    v[a] = _mm512_add_epi32(_mm512_add_epi32(v[a], v[b]), x); \
+    v[d] = _mm512_ror_epi32(_mm512_xor_si512(v[d], v[a]), 16); \
+    v[c] = _mm512_add_epi32(v[c], v[d]); \
+    v[b] = _mm512_ror_epi32(_mm512_xor_si512(v[b], v[c]), 12); \
+    v[a] = _mm512_add_epi32(_mm512_add_epi32(v[a], v[b]), y); \
+    v[d] = _mm512_ror_epi32(_mm512_xor_si512(v[d], v[a]), 8); \
+    v[c] = _mm512_add_epi32(v[c], v[d]); \
+    v[b] = _mm512_ror_epi32(_mm512_xor_si512(v[b], v[c]), 7); \
+} while (0)
+
+/* 16 consecutive chunks, lane j compresses input + j * BLAKE3_CHUNK_LEN */
+__attribute__((target("avx512f")))
+static void hash_chunks_x16(const uint8_t *input, uint64_t counter, uint32_t out[][8]) {
+    const __m512i index = _mm512_setr_epi32(0, 256, 512, 768, 1024, 1280, 1536, 1792,
+                                            2048, 2304, 2560, 2816, 3072, 3328, 3584, 3840);
+    alignas(64) uint32_t lanes[8][16];
+    __m512i cv[8], m[16], v[16], counter_lo, counter_hi;
+    unsigned i, j, b, r;
+
+    for (j = 0; j < 16; j++) {
+        lanes[0][j] = (uint32_t) (counter + j);
+        lanes[1][j] = (uint32_t) ((counter + j) >> 32);
+    }
+    counter_lo = _mm512_load_si512((const void *) lanes[0]);
+    counter_hi = _mm512_load_si512((const void *) lanes[1]);
+
+    for (i = 0; i < 8; i++)
+        cv[i] = _mm512_set1_epi32((int) blake3_iv[i]);
+
+    for (b = 0; b < BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN; b++) {
+        uint32_t flags = (b == 0 ? CHUNK_START : 0) |
+                         (b == BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN - 1 ? CHUNK_END : 0);
+
+        for (i = 0; i < 16; i++)
+            m[i] = _mm512_i32gather_epi32(index, (const void *) (input + b * BLAKE3_BLOCK_LEN + 4 * i), 4);
+
+        for (i = 0; i < 8; i++) v[i] = cv[i];
+        for (i = 0; i < 4; i++) v[i + 8] = _mm512_set1_epi32((int) blake3_iv[i]);
+        v[12] = counter_lo;
+        v[13] = counter_hi;
+        v[14] = _mm512_set1_epi32(BLAKE3_BLOCK_LEN);
+        v[15] = _mm512_set1_epi32((int) flags);
+
+        for (r = 0; r < 7; r++) {
+            const uint8_t *s = blake3_schedule[r];
+            BLAKE3_G_X16(v, 0, 4,  8, 12, m[s[0]],  m[s[1]]);
+            BLAKE3_G_X16(v, 1, 5,  9, 13, m[s[2]],  m[s[3]]);
+            BLAKE3_G_X16(v, 2, 6, 10, 14, m[s[4]],  m[s[5]]);
+            BLAKE3_G_X16(v, 3, 7, 11, 15, m[s[6]],  m[s[7]]);
+            BLAKE3_G_X16(v, 0, 5, 10, 15, m[s[8]],  m[s[9]]);
+            BLAKE3_G_X16(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+            BLAKE3_G_X16(v, 2, 7,  8, 13, m[s[12]], m[s[13]]);
+            BLAKE3_G_X16(v, 3, 4,  9, 14, m[s[14]], m[s[15]]);
+        }
+
+        for (i = 0; i < 8; i++)
+            cv[i] = _mm512_xor_si512(v[i], v[i + 8]);
+    }
+
+    for (i = 0; i < 8; i++)
+        _mm512_store_si512((void *) lanes[i], cv[i]);
+    for (j = 0; j < 16; j++)
+        for (i = 0; i < 8; i++)
+            out[j][i] = lanes[i][j];
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+static unsigned blake3_lanes_detect(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return 16;
+    if (__builtin_cpu_supports("avx2"))
+        return 8;
+    return 1;
+}
+
+#endif
+
+/* chaining values of count consecutive full chunks, the first one has index counter */
+static void hash_chunks(const uint8_t *input, size_t count, uint64_t counter, uint32_t out[][8]) {
+    size_t i = 0;
+
+#if BLAKE3_X86
+    unsigned lanes = blake3_lanes();
+
+    for (; lanes >= 16 && count - i >= 16; i += 16)
+        hash_chunks_x16(input + i * BLAKE3_CHUNK_LEN, counter + i, out + i);
+    for (; lanes >= 8 && count - i >= 8; i += 8)
+        hash_chunks_x8(input + i * BLAKE3_CHUNK_LEN, counter + i, out + i);
+#endif
+
+    for (; i < count; i++)
+        hash_chunk(input + i * BLAKE3_CHUNK_LEN, counter + i, out[i]);
+}
+
+static void parent_cv(const uint32_t left[8], const uint32_t right[8], uint32_t out[8]) {
+    uint32_t m[16], state[16];
+    memcpy(m, left, 8 * sizeof(uint32_t));
+    memcpy(m + 8, right, 8 * sizeof(uint32_t));
+    compress(blake3_iv, m, BLAKE3_BLOCK_LEN, 0, PARENT, state);
+    memcpy(out, state, 8 * sizeof(uint32_t));
+}
+
+/* chaining value of BLAKE3_SUBTREE_CHUNKS full chunks */
+static void hash_subtree(const uint8_t *input, uint64_t counter, uint32_t out[8]) {
+    uint32_t cvs[BLAKE3_SUBTREE_CHUNKS][8];
+    size_t n, i;
+
+    hash_chunks(input, BLAKE3_SUBTREE_CHUNKS, counter, cvs);
+    for (n = BLAKE3_SUBTREE_CHUNKS; n > 1; n /= 2)
+        for (i = 0; i < n / 2; i++)
+            parent_cv(cvs[2 * i], cvs[2 * i + 1], cvs[i]);
+    memcpy(out, cvs[0], 8 * sizeof(uint32_t));
+}
+
+/* Push the chaining value of a complete subtree. total is the number of
+ * subtrees of its size hashed so far including this one, every sibling
+ * pair it completes is merged right away. */
+static void push_cv(blake3_hasher *self, const uint32_t cv[8], uint64_t total) {
+    uint32_t merged[8];
+    memcpy(merged, cv, sizeof(merged));
+    while ((total & 1) == 0) {
+        self->cv_stack_len--;
+        parent_cv(self->cv_stack[self->cv_stack_len], merged, merged);
+        total >>= 1;
+    }
+    memcpy(self->cv_stack[self->cv_stack_len], merged, sizeof(merged));
+    self->cv_stack_len++;
+}
+
+static inline size_t chunk_len(const blake3_hasher *self) {
+    return (size_t) self->blocks_compressed * BLAKE3_BLOCK_LEN + self->buf_len;
+}
+
+static void chunk_output(const blake3_hasher *self, blake3_output *output) {
+    uint8_t block[BLAKE3_BLOCK_LEN] = {0};
+    memcpy(block, self->buf, self->buf_len);
+    memcpy(output->cv, self->cv, sizeof(output->cv));
+    load_block(block, output->m);
+    output->counter = self->chunk_counter;
+    output->block_len = self->buf_len;
+    output->flags = (self->blocks_compressed == 0 ? CHUNK_START : 0) | CHUNK_END;
+}
+
+static void chunk_reset(blake3_hasher *self, uint64_t counter) {
+    memcpy(self->cv, blake3_iv, sizeof(self->cv));
+    self->chunk_counter = counter;
+    self->buf_len = 0;
+    self->blocks_compressed = 0;
+}
+
+static void chunk_compress(blake3_hasher *self, const uint8_t *block) {
+    uint32_t m[16], state[16];
+    load_block(block, m);
+    compress(self->cv, m, BLAKE3_BLOCK_LEN, self->chunk_counter,
+             self->blocks_compressed == 0 ? CHUNK_START : 0, state);
+    memcpy(self->cv, state, sizeof(self->cv));
+    self->blocks_compressed++;
+}
+
+/* the current chunk is full and more input follows: it is not the root */
+static void chunk_finish(blake3_hasher *self) {
+    blake3_output output;
+    uint32_t state[16];
+    chunk_output(self, &output);
+    compress(output.cv, output.m, output.block_len, output.counter, output.flags, state);
+    push_cv(self, state, self->chunk_counter + 1);
+    chunk_reset(self, self->chunk_counter + 1);
+}
+
+static void chunk_update(blake3_hasher *self, const uint8_t *input, size_t len) {
+    while (len > 0) {
+        size_t take;
+        if (self->buf_len == BLAKE3_BLOCK_LEN) {
+            chunk_compress(self, self->buf);
+            self->buf_len = 0;
+        }
+        /* whole blocks are compressed in place while more input follows them */
+        while (self->buf_len == 0 && len > BLAKE3_BLOCK_LEN) {
+            chunk_compress(self, input);
+            input += BLAKE3_BLOCK_LEN;
+            len -= BLAKE3_BLOCK_LEN;
+        }
+        take = std::min<size_t>(BLAKE3_BLOCK_LEN - self->buf_len, len);
+        memcpy(self->buf + self->buf_len, input, take);
+        self->buf_len += (uint8_t) take;
+        input += take;
+        len -= take;
+    }
+}
+
+/* *************************** Public Inteface ************************ */
+
+unsigned blake3_lanes(void) {
+#if BLAKE3_X86
+    static const unsigned lanes = blake3_lanes_detect();
+    return lanes;
+#else
+    return 1;
+#endif
+}
+
+void blake3_hasher_init(blake3_hasher *self) {
+    chunk_reset(self, 0);
+    self->cv_stack_len = 0;
+}
+
+void blake3_hasher_update(blake3_hasher *self, const void *input, size_t input_len) {
+    const uint8_t *in = (const uint8_t *) input;
+    uint32_t cvs[BLAKE3_LANES_MAX][8];
+
+    while (input_len > 0) {
+        if (chunk_len(self) == BLAKE3_CHUNK_LEN)
+            chunk_finish(self);
+
+        if (chunk_len(self) == 0 && input_len > BLAKE3_CHUNK_LEN) {
+            /* full chunks followed by more input */
+            size_t count = std::min<size_t>((input_len - 1) / BLAKE3_CHUNK_LEN, BLAKE3_LANES_MAX);
+            size_t i;
+            hash_chunks(in, count, self->chunk_counter, cvs);
+            for (i = 0; i < count; i++)
+                push_cv(self, cvs[i], self->chunk_counter + i + 1);
+            chunk_reset(self, self->chunk_counter + count);
+            in += count * BLAKE3_CHUNK_LEN;
+            input_len -= count * BLAKE3_CHUNK_LEN;
+            continue;
+        }
+
+        size_t take = std::min(BLAKE3_CHUNK_LEN - chunk_len(self), input_len);
+        chunk_update(self, in, take);
+        in += take;
+        input_len -= take;
+    }
+}
+
+void blake3_hasher_update_parallel(blake3_hasher *self, const void *input, size_t input_len, size_t threads) {
+    const uint8_t *in = (const uint8_t *) input;
+    uint64_t absorbed = self->chunk_counter * BLAKE3_CHUNK_LEN + chunk_len(self);
+    size_t head = (size_t) ((BLAKE3_SUBTREE_LEN - absorbed % BLAKE3_SUBTREE_LEN) % BLAKE3_SUBTREE_LEN);
+    size_t subtrees, i;
+    uint64_t subtree_index;
+
+    if (input_len <= 2 * BLAKE3_SUBTREES_PER_THREAD * BLAKE3_SUBTREE_LEN) {
+        blake3_hasher_update(self, in, input_len);
+        return;
+    }
+
+    /* subtrees start at a multiple of their size */
+    head = std::min(head, input_len);
+    blake3_hasher_update(self, in, head);
+    in += head;
+    input_len -= head;
+
+    /* whole subtrees followed by more input */
+    subtrees = input_len > 0 ? (input_len - 1) / BLAKE3_SUBTREE_LEN : 0;
+    threads = ed25519::thread_ranges::worker_count(threads, subtrees, BLAKE3_SUBTREES_PER_THREAD);
+
+    if (threads > 1) {
+        std::vector<uint32_t> cvs(subtrees * 8);
+
+        if (chunk_len(self) == BLAKE3_CHUNK_LEN)
+            chunk_finish(self);
+
+        auto hash_range = [&cvs, in, self](size_t from, size_t to) {
+            for (size_t k = from; k < to; k++)
+                hash_subtree(in + k * BLAKE3_SUBTREE_LEN,
+                             self->chunk_counter + k * BLAKE3_SUBTREE_CHUNKS,
+                             &cvs[k * 8]);
+        };
+
+        ed25519::thread_ranges::run_ranges(subtrees, threads, hash_range);
+
+        subtree_index = self->chunk_counter / BLAKE3_SUBTREE_CHUNKS;
+        for (i = 0; i < subtrees; i++)
+            push_cv(self, &cvs[i * 8], subtree_index + i + 1);
+        chunk_reset(self, self->chunk_counter + subtrees * BLAKE3_SUBTREE_CHUNKS);
+
+        in += subtrees * BLAKE3_SUBTREE_LEN;
+        input_len -= subtrees * BLAKE3_SUBTREE_LEN;
+    }
+
+    blake3_hasher_update(self, in, input_len);
+}
+
+void blake3_hasher_finalize(const blake3_hasher *self, uint8_t *out, size_t out_len) {
+    blake3_output output;
+    uint32_t state[16];
+    uint64_t block;
+    size_t i;
+    unsigned n;
+
+    chunk_output(self, &output);
+
+    for (n = self->cv_stack_len; n > 0; n--) {
+        compress(output.cv, output.m, output.block_len, output.counter, output.flags, state);
+        memcpy(output.cv, blake3_iv, sizeof(output.cv));
+        memcpy(output.m, self->cv_stack[n - 1], 8 * sizeof(uint32_t));
+        memcpy(output.m + 8, state, 8 * sizeof(uint32_t));
+        output.counter = 0;
+        output.block_len = BLAKE3_BLOCK_LEN;
+        output.flags = PARENT;
+    }
+
+    for (block = 0; out_len > 0; block++) {
+        uint8_t bytes[BLAKE3_BLOCK_LEN];
+        size_t take = std::min<size_t>(out_len, BLAKE3_BLOCK_LEN);
+        compress(output.cv, output.m, output.block_len, block, output.flags | ROOT, state);
+        for (i = 0; i < 16; i++)
+            store32_le(bytes + 4 * i, state[i]);
+        memcpy(out, bytes, take);
+        out += take;
+        out_len -= take;
+    }
+}
@@ -0,0 +1,56 @@
+//
+// BLAKE3 hash mode (unkeyed, 256-bit output and XOF).
+//
+// Full chunks are compressed in parallel SIMD lanes: 16 with AVX-512,
+// 8 with AVX2, one by one otherwise. Large inputs can additionally be
+// split into subtrees hashed on several threads.
+//
+
+#ifndef _BLAKE3_H
+#define _BLAKE3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLAKE3_OUT_LEN 32
+#define BLAKE3_BLOCK_LEN 64
+#define BLAKE3_CHUNK_LEN 1024
+/* 2^54 chunks is 2^64 bytes */
+#define BLAKE3_MAX_DEPTH 54
+#define BLAKE3_LANES_MAX 16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct blake3_hasher_ {
+    uint32_t cv[8];             /* chaining value of the current chunk */
+    uint64_t chunk_counter;     /* index of the current chunk */
+    uint8_t buf[BLAKE3_BLOCK_LEN]; /* last block of the current chunk, it is
+                                 * compressed only when more input follows */
+    uint8_t buf_len;
+    uint8_t blocks_compressed;
+    uint8_t cv_stack_len;
+    uint32_t cv_stack[BLAKE3_MAX_DEPTH + 1][8]; /* chaining values of complete
+                                 * subtrees, merged as soon as a sibling is done */
+} blake3_hasher;
+
+/* Number of chunks the running CPU compresses at once:
+ * 16 (AVX-512), 8 (AVX2) or 1 (portable path) */
+unsigned blake3_lanes(void);
+
+void blake3_hasher_init(blake3_hasher *self);
+void blake3_hasher_update(blake3_hasher *self, const void *input, size_t input_len);
+
+/* Same result as blake3_hasher_update, subtrees of a large input are hashed
+ * on up to threads threads, 0 uses every hardware thread */
+void blake3_hasher_update_parallel(blake3_hasher *self, const void *input, size_t input_len, size_t threads);
+
+/* The hasher is not modified and can be updated further */
+void blake3_hasher_finalize(const blake3_hasher *self, uint8_t *out, size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,8 +12,6 @@
 #include <algorithm>
 #include <assert.h>
 #include <string.h>
-#include <iomanip>
-#include <iostream>
 
 
 /** All alphanumeric characters except for "0", "I", "O", and "l" */
@@ -21,149 +19,53 @@ static const char* pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnop
 
 namespace ed25519::base58 {
 
-
-    string BinToHex(const vector<unsigned char> &data) {
-        // note: optimize
-        string convert;
-        convert.reserve(data.size() * 2 + 2);
-        std::stringstream s(convert);
-        s << std::hex;
-        for (size_t i = 0; i < data.size(); i++) {
-            s << std::setw(2) << std::setfill('0') << (unsigned int) data[i];
-        }
-        return s.str();
-    }
-
-    bool HexToBin(const string &hexString, vector<unsigned char> &data, string &errorDescription) {
-        // code 255 means error
-        static unsigned char sDecLookupTable[] =
-                {
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 255, 255, 255, 255, 255, 255, // 0123456789
-                        255, 10, 11, 12, 13, 14, 15, 255, 255, 255, 255, 255, 255, 255, 255, 255, //  ABCDEF
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, //
-                        255, 10, 11, 12, 13, 14, 15, 255, 255, 255, 255, 255, 255, 255, 255, 255, //  abcdef
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-                        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
-                };
-
-        errorDescription = "";
-        data.clear();
-
-        if ((hexString.size() & 1) != 0) {
-            errorDescription = StringFormat("string with odd size: %zu bytes", hexString.size());
-            return false;
-        }
-
-        size_t binarySize = hexString.size() >> 1; // /2
-
-        data.resize(binarySize);
-
-        for (size_t i = 0, j = 0; i < binarySize; i++, j += 2) {
-            unsigned char h1 = hexString[j];
-            unsigned char h0 = hexString[j + 1];
-            //
-            unsigned char c1 = sDecLookupTable[h1];
-            unsigned char c0 = sDecLookupTable[h0];
-            // check for errors
-            if (c1 == 255 || c0 == 255) {
-                errorDescription = StringFormat("bad %u hex symbol '%c%c'", i, h1, h0);
-                return false;
-            }
-            data[i] = (c1 << 4) | c0;
-        }
-
-        return true;
-    }
-
-    bool HexStringToUchar(const string &hexString, unsigned char &value) {
-        if (hexString.empty()) {
-            return false;
-        }
-
-        string s = hexString;
-
-        if (s.size() > 2 && s[0] == '0' && s[1] == 'x') {
-            s = hexString.substr(2);
-        }
-
-        if (s.size() > (sizeof(unsigned char) * 2)) {
-            return false;
-        }
-
-        unsigned int v = 0;
-        std::stringstream ss;
-        ss << std::hex << s;
-        ss >> v;
-
-        // check that all symbols are processed e.g. 0xfz -> error
-        if (ss.fail() || !ss.eof()) {
-            return false;
-        }
-
-        if (v > static_cast<unsigned int>(std::numeric_limits<unsigned char>::max())) {
-            return false;
-        }
-
-        value = static_cast<unsigned char>(v);
-
-        return true;
-    }
-
-    uint_least32_t crc32(unsigned char *buf, size_t len) {
-        uint_least32_t crc_table[256] = {};
-        uint_least32_t crc = {};
-
-        for (int i = 0; i < 256; i++) {
-            crc = i;
-            for (int j = 0; j < 8; j++) {
-                crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
-            }
-            crc_table[i] = crc;
-        }
-
-        crc = 0xFFFFFFFFUL;
-        while (len--) {
-            crc = crc_table[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
-        }
-
-        return crc ^ 0xFFFFFFFFUL;
-    }
-
-    bool DecodeBase58(const char *psz, vector<unsigned char> &vch) {
+    const int8_t mapBase58[256] = {
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1, 0, 1, 2, 3, 4, 5, 6,  7, 8,-1,-1,-1,-1,-1,-1,
+            -1, 9,10,11,12,13,14,15, 16,-1,17,18,19,20,21,-1,
+            22,23,24,25,26,27,28,29, 30,31,32,-1,-1,-1,-1,-1,
+            -1,33,34,35,36,37,38,39, 40,41,42,43,-1,44,45,46,
+            47,48,49,50,51,52,53,54, 55,56,57,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+            -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
+    };
+
+    bool DecodeBase58(const char *psz, const char *end, unsigned char *vch, size_t capacity, size_t &size) {
         // Skip leading spaces.
-        while (*psz && isspace(*psz))
+        while (psz != end && isspace(*psz))
             psz++;
         // Skip and count leading '1's.
-        int zeroes = 0;
+        size_t zeroes = 0;
         int length = 0;
-        while (*psz == '1') {
+        while (psz != end && *psz == '1') {
             zeroes++;
             psz++;
         }
-        // Allocate enough space in big-endian base256 representation.
-        int size = (int) strlen(psz) * 733 / 1000 + 1; // log(58) / log(256), rounded up.
-        std::vector<unsigned char> b256(size);
+        // Enough space in big-endian base256 representation right after the zeroes.
+        size_t b256_size = static_cast<size_t>(end - psz) * 733 / 1000 + 1; // log(58) / log(256), rounded up.
+        if (zeroes + b256_size > capacity)
+            return false;
+        unsigned char *b256 = vch + zeroes;
+        unsigned char *b256_end = b256 + b256_size;
+        memset(b256, 0, b256_size);
         // Process the characters.
-        while (*psz && !isspace(*psz)) {
+        while (psz != end && !isspace(*psz)) {
             // Decode base58 character
-            const char *ch = strchr(pszBase58, *psz);
-            if (ch == nullptr)
+            int carry = mapBase58[static_cast<uint8_t>(*psz)];
+            if (carry == -1)
                 return false;
             // Apply "b256 = b256 * 58 + ch".
-            int carry = (int) (ch - pszBase58);
             int i = 0;
-            for (std::vector<unsigned char>::reverse_iterator it = b256.rbegin();
-                 (carry != 0 || i < length) && (it != b256.rend()); ++it, ++i) {
+            for (unsigned char *it = b256_end; (carry != 0 || i < length) && (it != b256); ++i) {
+                --it;
                 carry += 58 * (*it);
                 *it = carry % 256;
                 carry /= 256;
@@ -173,19 +75,29 @@ namespace ed25519::base58 {
             psz++;
         }
         // Skip trailing spaces.
-        while (isspace(*psz))
+        while (psz != end && isspace(*psz))
             psz++;
-        if (*psz != 0)
+        if (psz != end)
             return false;
         // Skip leading zeroes in b256.
-        std::vector<unsigned char>::iterator it = b256.begin() + (size - length);
-        while (it != b256.end() && *it == 0)
+        unsigned char *it = b256_end - length;
+        while (it != b256_end && *it == 0)
             it++;
-        // Copy result into output vector.
-        vch.reserve(zeroes + (b256.end() - it));
-        vch.assign(zeroes, 0x00);
-        while (it != b256.end())
-            vch.push_back(*(it++));
+        // Move the significant bytes right after the zeroes.
+        memset(vch, 0, zeroes);
+        memmove(b256, it, b256_end - it);
+        size = zeroes + (b256_end - it);
+        return true;
+    }
+
+    bool DecodeBase58(const char *psz, vector<unsigned char> &vch) {
+        size_t size = 0;
+        vch.resize(strlen(psz) + 1);
+        if (!DecodeBase58(psz, psz + strlen(psz), vch.data(), vch.size(), size)) {
+            vch.clear();
+            return false;
+        }
+        vch.resize(size);
         return true;
     }
 
@@ -236,7 +148,15 @@ namespace ed25519::base58 {
     }
 
     bool DecodeBase58(const string &str, vector<unsigned char> &vchRet) {
-        return DecodeBase58(str.c_str(), vchRet);
+        // the whole string: an embedded '\0' is not a base58 character
+        size_t size = 0;
+        vchRet.resize(str.size() + 1);
+        if (!DecodeBase58(str.data(), str.data() + str.size(), vchRet.data(), vchRet.size(), size)) {
+            vchRet.clear();
+            return false;
+        }
+        vchRet.resize(size);
+        return true;
     }
 
     string EncodeBase58Check(const vector<unsigned char> &vchIn) {
@@ -256,25 +176,18 @@ namespace ed25519::base58 {
         return EncodeBase58(vch);
     }
 
-    bool DecodeBase58Check(const char *psz, vector<unsigned char> &vchRet) {
-        if (!DecodeBase58(psz, vchRet) || (vchRet.size() < 4)) {
-            vchRet.clear();
+    bool CheckCrc32(const unsigned char *vch, size_t size) {
+        if (size < 4)
             return false;
-        }
-        // re-calculate the checksum, ensure it matches the included 4-byte checksum
-        // uint256 hash = Hash(vchRet.begin(), vchRet.end() - 4);
-        // if (memcmp(&hash, &vchRet[vchRet.size() - 4], 4) != 0) {
-        //     vchRet.clear();
-        //     return false;
-        // }
-        size_t sz = vchRet.size();
-        //
-        uint_least32_t crc32_ = crc32(&vchRet[0], sz - 4);
-        //
-        if (static_cast<unsigned char>(crc32_ & 0xff) != vchRet[sz - 4] ||
-            static_cast<unsigned char>((crc32_ >> 8) & 0xff) != vchRet[sz - 3] ||
-            static_cast<unsigned char>((crc32_ >> 16) & 0xff) != vchRet[sz - 2] ||
-            static_cast<unsigned char>((crc32_ >> 24) & 0xff) != vchRet[sz - 1]) {
+        uint_least32_t crc32_ = crc32(vch, size - 4);
+        return static_cast<unsigned char>(crc32_ & 0xff) == vch[size - 4] &&
+               static_cast<unsigned char>((crc32_ >> 8) & 0xff) == vch[size - 3] &&
+               static_cast<unsigned char>((crc32_ >> 16) & 0xff) == vch[size - 2] &&
+               static_cast<unsigned char>((crc32_ >> 24) & 0xff) == vch[size - 1];
+    }
+
+    bool DecodeBase58Check(const char *psz, vector<unsigned char> &vchRet) {
+        if (!DecodeBase58(psz, vchRet) || !CheckCrc32(vchRet.data(), vchRet.size())) {
             vchRet.clear();
             return false;
         }
@@ -284,13 +197,27 @@ namespace ed25519::base58 {
     }
 
     bool DecodeBase58Check(const string &str, vector<unsigned char> &vchRet) {
-        return DecodeBase58Check(str.c_str(), vchRet);
+        if (!DecodeBase58(str, vchRet) || !CheckCrc32(vchRet.data(), vchRet.size())) {
+            vchRet.clear();
+            return false;
+        }
+        vchRet.resize(vchRet.size() - 4);
+
+        return true;
     }
 
-    /// TODO:
-    /// . make more effective
     bool Base58Check(const string &str) {
-        vector<unsigned char> vchRet;
-        return DecodeBase58Check(str.c_str(), vchRet);
+        // strings of keys, digests and signatures are decoded on the stack
+        unsigned char stack[256];
+        vector<unsigned char> heap;
+        unsigned char *vch = stack;
+        size_t capacity = sizeof(stack);
+        if (str.size() >= capacity) {
+            heap.resize(str.size() + 1);
+            vch = heap.data();
+            capacity = heap.size();
+        }
+        size_t size = 0;
+        return DecodeBase58(str.data(), str.data() + str.size(), vch, capacity, size) && CheckCrc32(vch, size);
     }
 }
\ No newline at end of file
@@ -28,6 +28,23 @@ using std::vector;
 using std::array;
 
 namespace ed25519::base58 {
+    /**
+     * Digit of every base58 character, -1 for other characters
+     */
+    extern const int8_t mapBase58[256];
+
+    /**
+     * Decode [psz, end) into a caller buffer without allocations, the buffer must be longer
+     * than end - psz: every leading '1' is one byte, other digits take less
+     * @return false if the string is not base58 or the buffer is too small
+     */
+    bool DecodeBase58(const char *psz, const char *end, unsigned char *vch, size_t capacity, size_t &size);
+
+    /**
+     * Compare the trailing 4-byte little endian checksum with crc32 of the payload
+     */
+    bool CheckCrc32(const unsigned char *vch, size_t size);
+
     /**
      * Encode a byte vector as a base58-encoded string
      */
@@ -0,0 +1,194 @@
+//
+// CRC-32 with slicing-by-8 and PCLMULQDQ folding.
+//
+// The folding follows "Fast CRC Computation for Generic Polynomials Using
+// PCLMULQDQ Instruction" (Gopal et al., Intel), with the constants of the
+// reflected IEEE polynomial used by zlib: four 128-bit lanes are folded
+// 64 bytes at a time, reduced to 128 bits, then to 32 bits by Barrett
+// reduction. Both paths work on the inverted register; the public
+// functions apply the pre- and post-inversion.
+//
+
+#include <string.h>
+#include <array>
+#include "crc32.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32_X86 1
+#include <immintrin.h>
+#else
+#define CRC32_X86 0
+#endif
+
+namespace {
+
+    typedef std::array<std::array<uint32_t, 256>, 8> crc32_tables;
+
+    /* tables[k][i]: crc of byte i followed by k zero bytes */
+    constexpr crc32_tables make_tables() {
+        crc32_tables tables{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; j++)
+                crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+            tables[0][i] = crc;
+        }
+        for (size_t k = 1; k < 8; k++)
+            for (size_t i = 0; i < 256; i++)
+                tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xff];
+        return tables;
+    }
+
+    constexpr crc32_tables tables = make_tables();
+
+    inline uint32_t load32_le(const unsigned char *p) {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    uint32_t table_update(uint32_t reg, const unsigned char *buf, size_t len) {
+        while (len >= 8) {
+            uint32_t one = load32_le(buf) ^ reg;
+            uint32_t two = load32_le(buf + 4);
+            reg = tables[7][one & 0xff] ^ tables[6][(one >> 8) & 0xff] ^
+                  tables[5][(one >> 16) & 0xff] ^ tables[4][one >> 24] ^
+                  tables[3][two & 0xff] ^ tables[2][(two >> 8) & 0xff] ^
+                  tables[1][(two >> 16) & 0xff] ^ tables[0][two >> 24];
+            buf += 8;
+            len -= 8;
+        }
+        while (len--)
+            reg = tables[0][(reg ^ *buf++) & 0xff] ^ (reg >> 8);
+        return reg;
+    }
+
+#if CRC32_X86
+
+    /* len is at least 64 and a multiple of 16 */
+    __attribute__((target("pclmul,sse4.1")))
+    uint32_t clmul_update(uint32_t reg, const unsigned char *buf, size_t len) {
+        alignas(16) static const uint64_t k1k2[] = {0x0154442bd4ULL, 0x01c6e41596ULL};
+        alignas(16) static const uint64_t k3k4[] = {0x01751997d0ULL, 0x00ccaa009eULL};
+        alignas(16) static const uint64_t k5k0[] = {0x0163cd6124ULL, 0x0000000000ULL};
+        alignas(16) static const uint64_t poly[] = {0x01db710641ULL, 0x01f7011641ULL};
+
+        __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+        x1 = _mm_loadu_si128((const __m128i *) (buf + 0x00));
+        x2 = _mm_loadu_si128((const __m128i *) (buf + 0x10));
+        x3 = _mm_loadu_si128((const __m128i *) (buf + 0x20));
+        x4 = _mm_loadu_si128((const __m128i *) (buf + 0x30));
+
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) reg));
+
+        x0 = _mm_load_si128((const __m128i *) k1k2);
+
+        buf += 64;
+        len -= 64;
+
+        /* fold 4 lanes by 64 bytes */
+        while (len >= 64) {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+            x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+            x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+            y5 = _mm_loadu_si128((const __m128i *) (buf + 0x00));
+            y6 = _mm_loadu_si128((const __m128i *) (buf + 0x10));
+            y7 = _mm_loadu_si128((const __m128i *) (buf + 0x20));
+            y8 = _mm_loadu_si128((const __m128i *) (buf + 0x30));
+
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+            buf += 64;
+            len -= 64;
+        }
+
+        /* fold the lanes into 128 bits */
+        x0 = _mm_load_si128((const __m128i *) k3k4);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+        /* fold the rest by 16 bytes */
+        while (len >= 16) {
+            x2 = _mm_loadu_si128((const __m128i *) buf);
+
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+            buf += 16;
+            len -= 16;
+        }
+
+        /* 128 to 64 bits */
+        x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+        x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x1 = _mm_srli_si128(x1, 8);
+        x1 = _mm_xor_si128(x1, x2);
+
+        x0 = _mm_loadl_epi64((const __m128i *) k5k0);
+
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_and_si128(x1, x3);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        /* Barrett reduction to 32 bits */
+        x0 = _mm_load_si128((const __m128i *) poly);
+
+        x2 = _mm_and_si128(x1, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+        x2 = _mm_and_si128(x2, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        return (uint32_t) _mm_extract_epi32(x1, 1);
+    }
+
+    bool has_clmul() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+    }
+
+#endif
+}
+
+/* *************************** Public Inteface ************************ */
+
+uint32_t crc32_update(uint32_t crc, const unsigned char *buf, size_t len) {
+    uint32_t reg = ~crc;
+
+#if CRC32_X86
+    static const bool clmul = has_clmul();
+    if (clmul && len >= 64) {
+        size_t folded = len & ~(size_t) 15;
+        reg = clmul_update(reg, buf, folded);
+        buf += folded;
+        len -= folded;
+    }
+#endif
+
+    return ~table_update(reg, buf, len);
+}
+
+uint32_t crc32_update_table(uint32_t crc, const unsigned char *buf, size_t len) {
+    return ~table_update(~crc, buf, len);
+}
@@ -0,0 +1,28 @@
+//
+// CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320), the zlib crc32.
+//
+// Slicing-by-8 over compile-time tables, inputs of 64 bytes and more are
+// folded with carry-less multiplication (PCLMULQDQ) when the CPU has it.
+//
+
+#ifndef _CRC32_H
+#define _CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Continue crc over len bytes, start with 0: crc32_update(0, buf, len) */
+uint32_t crc32_update(uint32_t crc, const unsigned char *buf, size_t len);
+
+/* Table-driven path only, the reference for the PCLMULQDQ path */
+uint32_t crc32_update_table(uint32_t crc, const unsigned char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
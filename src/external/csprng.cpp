@@ -0,0 +1,273 @@
+//
+// ChaCha20 generator with fast key erasure, keyed from the system source.
+//
+
+#include <atomic>
+#include <string.h>
+#include <stdint.h>
+#include "csprng.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <wincrypt.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/random.h>)
+#include <sys/random.h>
+#define CSPRNG_GETRANDOM 1
+#endif
+#endif
+#endif
+
+namespace {
+
+    /* blocks generated at once: one keys the next refill, the rest is output */
+    constexpr size_t refill_blocks = 8;
+    constexpr size_t buffer_size = (refill_blocks - 1) * 64 + 32;
+
+    inline uint32_t load32_le(const unsigned char *p) {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    inline void store32_le(unsigned char *p, uint32_t v) {
+        p[0] = (unsigned char) v;
+        p[1] = (unsigned char) (v >> 8);
+        p[2] = (unsigned char) (v >> 16);
+        p[3] = (unsigned char) (v >> 24);
+    }
+
+    inline uint32_t rotl(uint32_t v, int c) { return (v << c) | (v >> (32 - c)); }
+
+#define QUARTERROUND(a, b, c, d) \
+    a += b; d ^= a; d = rotl(d, 16); \
+    c += d; b ^= c; b = rotl(b, 12); \
+    a += b; d ^= a; d = rotl(d, 8);  \
+    c += d; b ^= c; b = rotl(b, 7);
+
+    void chacha20_block(const uint32_t input[16], unsigned char out[64]) {
+        uint32_t x[16];
+        memcpy(x, input, sizeof(x));
+
+        for (int i = 0; i < 10; i++) {
+            QUARTERROUND(x[0], x[4], x[8], x[12])
+            QUARTERROUND(x[1], x[5], x[9], x[13])
+            QUARTERROUND(x[2], x[6], x[10], x[14])
+            QUARTERROUND(x[3], x[7], x[11], x[15])
+            QUARTERROUND(x[0], x[5], x[10], x[15])
+            QUARTERROUND(x[1], x[6], x[11], x[12])
+            QUARTERROUND(x[2], x[7], x[8], x[13])
+            QUARTERROUND(x[3], x[4], x[9], x[14])
+        }
+
+        for (int i = 0; i < 16; i++)
+            store32_le(out + 4 * i, x[i] + input[i]);
+    }
+
+#undef QUARTERROUND
+
+    void chacha20_input(uint32_t input[16], const unsigned char key[32], uint32_t counter, const unsigned char nonce[12]) {
+        input[0] = 0x61707865;
+        input[1] = 0x3320646e;
+        input[2] = 0x79622d32;
+        input[3] = 0x6b206574;
+        for (int i = 0; i < 8; i++)
+            input[4 + i] = load32_le(key + 4 * i);
+        input[12] = counter;
+        for (int i = 0; i < 3; i++)
+            input[13 + i] = load32_le(nonce + 4 * i);
+    }
+
+    /* incremented in a child process, generators keyed before fork() rekey */
+    std::atomic<unsigned> fork_generation(0);
+
+#ifndef _WIN32
+    void on_fork_child() {
+        fork_generation.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+
+    bool watch_forks() {
+#ifndef _WIN32
+        return pthread_atfork(nullptr, nullptr, on_fork_child) == 0;
+#else
+        return true;
+#endif
+    }
+
+    /* false if the fork handler is not registered, generators compare getpid() on every draw then */
+    bool forks_watched() {
+        static const bool watching = watch_forks();
+        return watching;
+    }
+
+    struct generator {
+        unsigned char key[32];
+        unsigned char buffer[buffer_size];
+        size_t available;
+        size_t since_reseed;
+        unsigned generation;
+#ifndef _WIN32
+        pid_t pid;
+#endif
+        bool keyed;
+
+#ifndef _WIN32
+        generator(): key{}, buffer{}, available(0), since_reseed(0), generation(0), pid(0), keyed(false) {
+#else
+        generator(): key{}, buffer{}, available(0), since_reseed(0), generation(0), keyed(false) {
+#endif
+            // registered before the first key, a child forked afterwards is always noticed
+            forks_watched();
+        }
+
+        ~generator() {
+            volatile unsigned char *p = key;
+            for (size_t i = 0; i < sizeof(key); i++) p[i] = 0;
+            p = buffer;
+            for (size_t i = 0; i < sizeof(buffer); i++) p[i] = 0;
+        }
+
+        bool rekey() {
+            unsigned char fresh[32];
+            if (csprng_system_bytes(fresh, sizeof(fresh)) != 0)
+                return false;
+
+            // mix the old key in: a weak system source never makes the state weaker
+            for (size_t i = 0; i < sizeof(key); i++) key[i] ^= fresh[i];
+            memset(fresh, 0, sizeof(fresh));
+
+            available = 0;
+            since_reseed = 0;
+            generation = fork_generation.load(std::memory_order_relaxed);
+#ifndef _WIN32
+            pid = getpid();
+#endif
+            keyed = true;
+            return true;
+        }
+
+        void refill() {
+            static const unsigned char nonce[12] = {};
+            unsigned char blocks[refill_blocks * 64];
+            uint32_t input[16];
+
+            chacha20_input(input, key, 0, nonce);
+            for (uint32_t i = 0; i < refill_blocks; i++) {
+                input[12] = i;
+                chacha20_block(input, blocks + 64 * i);
+            }
+
+            memcpy(key, blocks, sizeof(key));
+            memcpy(buffer, blocks + sizeof(key), buffer_size);
+            available = buffer_size;
+
+            volatile unsigned char *p = blocks;
+            for (size_t i = 0; i < sizeof(blocks); i++) p[i] = 0;
+            memset(input, 0, sizeof(input));
+        }
+
+        /* the process is a child forked after the last rekey */
+        bool forked() const {
+#ifndef _WIN32
+            if (!forks_watched())
+                return getpid() != pid;
+#endif
+            return generation != fork_generation.load(std::memory_order_relaxed);
+        }
+
+        int bytes(unsigned char *out, size_t len) {
+            if (!keyed || since_reseed >= CSPRNG_RESEED_BYTES || forked()) {
+                if (!rekey())
+                    return 1;
+            }
+
+            since_reseed += len;
+
+            while (len > 0) {
+                if (available == 0)
+                    refill();
+                size_t n = len < available ? len : available;
+                unsigned char *from = buffer + buffer_size - available;
+                memcpy(out, from, n);
+                memset(from, 0, n);
+                available -= n;
+                out += n;
+                len -= n;
+            }
+
+            return 0;
+        }
+    };
+
+#ifndef _WIN32
+    int read_urandom(unsigned char *out, size_t len) {
+        int fd;
+        do {
+            fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        } while (fd < 0 && errno == EINTR);
+
+        if (fd < 0)
+            return 1;
+
+        while (len > 0) {
+            ssize_t n = read(fd, out, len);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                close(fd);
+                return 1;
+            }
+            out += n;
+            len -= (size_t) n;
+        }
+
+        close(fd);
+        return 0;
+    }
+#endif
+}
+
+/* *************************** Public Inteface ************************ */
+
+int csprng_bytes(unsigned char *out, size_t len) {
+    thread_local generator state;
+    return state.bytes(out, len);
+}
+
+int csprng_system_bytes(unsigned char *out, size_t len) {
+#if defined(_WIN32)
+    HCRYPTPROV prov;
+
+    if (!CryptAcquireContext(&prov, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT))
+        return 1;
+
+    BOOL done = CryptGenRandom(prov, (DWORD) len, out);
+    CryptReleaseContext(prov, 0);
+
+    return done ? 0 : 1;
+#elif defined(CSPRNG_GETRANDOM)
+    while (len > 0) {
+        ssize_t n = getrandom(out, len, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return errno == ENOSYS ? read_urandom(out, len) : 1;
+        out += n;
+        len -= (size_t) n;
+    }
+    return 0;
+#else
+    return read_urandom(out, len);
+#endif
+}
+
+void csprng_chacha20_block(const unsigned char key[32], unsigned counter, const unsigned char nonce[12],
+                           unsigned char out[64]) {
+    uint32_t input[16];
+    chacha20_input(input, key, counter, nonce);
+    chacha20_block(input, out);
+}
@@ -0,0 +1,37 @@
+//
+// Per-thread ChaCha20 random generator for seeds.
+//
+// Every thread keys its own generator from the system source (getrandom(2)
+// where available), then hands out bytes of buffered ChaCha20 output. The
+// first 32 bytes of every refill replace the key ("fast key erasure"), so
+// the state never lets earlier output be recomputed. The generator rekeys
+// from the system source after CSPRNG_RESEED_BYTES of output and in a child
+// process after fork().
+//
+
+#ifndef _CSPRNG_H
+#define _CSPRNG_H
+
+#include <stddef.h>
+
+#define CSPRNG_RESEED_BYTES (1024 * 1024)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fill out with len random bytes, returns 0 or 1 if the system source is unavailable */
+int csprng_bytes(unsigned char *out, size_t len);
+
+/* Fill out with len bytes of the system source, returns 0 or 1 on failure */
+int csprng_system_bytes(unsigned char *out, size_t len);
+
+/* ChaCha20 keystream block (RFC 8439) */
+void csprng_chacha20_block(const unsigned char key[32], unsigned counter, const unsigned char nonce[12],
+                           unsigned char out[64]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
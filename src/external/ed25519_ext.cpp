@@ -1,11 +1,362 @@
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+#include "fe.h"
+#include "sc.h"
+}
+
 #include "sha512.h"
 #include "ge.h"
 #include "ed25519_ext.hpp"
 
+static_assert(sizeof(ge_cached) == ED25519_PREPARED_KEY_SIZE, "prepared key is the cached point");
+
 void ed25519_restore_from_private_key(unsigned char *public_key, const unsigned char *private_key) 
 {
     ge_p3 A;
 
     ge_scalarmult_base(&A, private_key);
     ge_p3_tobytes(public_key, &A);
-}
\ No newline at end of file
+}
+
+/* ge_p3_tobytes of n points, Montgomery's trick: products[i] = Z0 * ... * Zi, one inversion of the last gives every 1/Zi */
+static void p3_tobytes_batch(unsigned char *s, const ge_p3 *A, fe *products, size_t n)
+{
+    fe inverse, recip, x, y;
+    size_t i;
+
+    fe_copy(products[0], A[0].Z);
+    for (i = 1; i < n; ++i)
+        fe_mul(products[i], products[i - 1], A[i].Z);
+
+    fe_invert(inverse, products[n - 1]);
+
+    for (i = n; i-- > 0; ) {
+        if (i > 0) {
+            fe_mul(recip, inverse, products[i - 1]);
+            fe_mul(inverse, inverse, A[i].Z);
+        }
+        else {
+            fe_copy(recip, inverse);
+        }
+
+        fe_mul(x, A[i].X, recip);
+        fe_mul(y, A[i].Y, recip);
+        fe_tobytes(s + 32 * i, y);
+        s[32 * i + 31] ^= fe_isnegative(x) << 7;
+    }
+}
+
+void ed25519_create_keypairs(unsigned char *public_keys, unsigned char *private_keys,
+                             const unsigned char *seeds, size_t count)
+{
+    ge_p3 A[ED25519_KEYPAIRS_BATCH];
+    fe products[ED25519_KEYPAIRS_BATCH];
+    size_t first, n, i;
+
+    for (first = 0; first < count; first += n) {
+        n = count - first < ED25519_KEYPAIRS_BATCH ? count - first : ED25519_KEYPAIRS_BATCH;
+
+        for (i = 0; i < n; ++i) {
+            unsigned char *private_key = private_keys + 64 * (first + i);
+
+            /* one SHA-512 block is about 0.5 us against 30-40 us of ge_scalarmult_base,
+               hashing the seeds in SIMD lanes could not save more than 2% */
+            sha512(seeds + 32 * (first + i), 32, private_key);
+            private_key[0] &= 248;
+            private_key[31] &= 63;
+            private_key[31] |= 64;
+
+            ge_scalarmult_base(&A[i], private_key);
+        }
+
+        p3_tobytes_batch(public_keys + 32 * first, A, products, n);
+    }
+
+    memset(A, 0, sizeof(A));
+    memset(products, 0, sizeof(products));
+}
+
+void ed25519_verify_hash(unsigned char *h, const unsigned char *signature, const unsigned char *public_key,
+                         const unsigned char *message, size_t message_len)
+{
+    unsigned char digest[64];
+    sha512_context hash;
+
+    sha512_init(&hash);
+    sha512_update(&hash, signature, 32);
+    sha512_update(&hash, public_key, 32);
+    sha512_update(&hash, message, message_len);
+    sha512_final(&hash, digest);
+
+    sc_reduce(digest);
+    memcpy(h, digest, 32);
+}
+
+int ed25519_verify_hashed(const unsigned char *signature, const unsigned char *public_key, const unsigned char *h)
+{
+    unsigned char checker[32];
+    unsigned char r = 0;
+    ge_p3 A;
+    ge_p2 R;
+    int i;
+
+    if (signature[63] & 224) {
+        return 0;
+    }
+
+    if (ge_frombytes_negate_vartime(&A, public_key) != 0) {
+        return 0;
+    }
+
+    ge_double_scalarmult_vartime(&R, h, &A, signature + 32);
+    ge_tobytes(checker, &R);
+
+    for (i = 0; i < 32; ++i) {
+        r |= checker[i] ^ signature[i];
+    }
+
+    return r == 0;
+}
+
+int ed25519_prepare_public_key(unsigned char *prepared, const unsigned char *public_key)
+{
+    ge_p3 A;
+    ge_cached T;
+
+    if (ge_frombytes_negate_vartime(&A, public_key) != 0)
+        return 0;
+
+    /* undo negate, as ed25519_add_scalar does */
+    fe_neg(A.X, A.X);
+    fe_neg(A.T, A.T);
+    ge_p3_to_cached(&T, &A);
+
+    memcpy(prepared, &T, sizeof(T));
+    return 1;
+}
+
+void ed25519_derive_public_keys(unsigned char *public_keys, const unsigned char *prepared,
+                                const unsigned char *scalars, size_t count)
+{
+    ge_p3 A[ED25519_DERIVE_BATCH];
+    fe products[ED25519_DERIVE_BATCH];
+    unsigned char n[32];
+    ge_cached T;
+    ge_p3 nB;
+    ge_p1p1 sum;
+    size_t first, batch, i;
+
+    memcpy(&T, prepared, sizeof(T));
+
+    for (first = 0; first < count; first += batch) {
+        batch = count - first < ED25519_DERIVE_BATCH ? count - first : ED25519_DERIVE_BATCH;
+
+        for (i = 0; i < batch; ++i) {
+            /* copy the scalar and clear highest bit */
+            memcpy(n, scalars + 32 * (first + i), 32);
+            n[31] &= 127;
+
+            /* A = n*B + T */
+            ge_scalarmult_base(&nB, n);
+            ge_add(&sum, &nB, &T);
+            ge_p1p1_to_p3(&A[i], &sum);
+        }
+
+        p3_tobytes_batch(public_keys + 32 * first, A, products, batch);
+    }
+}
+
+static void clamp(unsigned char *e, const unsigned char *private_key)
+{
+    int i;
+
+    for (i = 0; i < 32; ++i) {
+        e[i] = private_key[i];
+    }
+
+    e[0] &= 248;
+    e[31] &= 63;
+    e[31] |= 64;
+}
+
+static void wipe(void *data, size_t size)
+{
+    volatile unsigned char *p = (volatile unsigned char *) data;
+    size_t i;
+
+    for (i = 0; i < size; ++i) p[i] = 0;
+}
+
+void ed25519_x25519_public_key(unsigned char *public_key, const unsigned char *private_key)
+{
+    unsigned char e[32];
+    ge_p3 A;
+    fe one_plus_y, one_minus_y;
+
+    clamp(e, private_key);
+    ge_scalarmult_base(&A, e);
+
+    /* birational map u = (1 + y) / (1 - y), with y = Y/Z: u = (Z + Y) / (Z - Y) */
+    fe_add(one_plus_y, A.Z, A.Y);
+    fe_sub(one_minus_y, A.Z, A.Y);
+    fe_invert(one_minus_y, one_minus_y);
+    fe_mul(one_plus_y, one_plus_y, one_minus_y);
+    fe_tobytes(public_key, one_plus_y);
+
+    wipe(e, sizeof(e));
+    wipe(&A, sizeof(A));
+}
+
+void ed25519_x25519(unsigned char *shared_secret, const unsigned char *public_key, const unsigned char *private_key)
+{
+    unsigned char e[32];
+    fe x1, x2, z2, x3, z3, tmp0, tmp1;
+    unsigned int swap, b;
+    int pos;
+
+    clamp(e, private_key);
+
+    /* the ladder of ed25519_key_exchange, the peer key is already Montgomery u; the top bit is ignored */
+    fe_frombytes(x1, public_key);
+
+    fe_1(x2);
+    fe_0(z2);
+    fe_copy(x3, x1);
+    fe_1(z3);
+
+    swap = 0;
+    for (pos = 254; pos >= 0; --pos) {
+        b = e[pos / 8] >> (pos & 7);
+        b &= 1;
+        swap ^= b;
+        fe_cswap(x2, x3, swap);
+        fe_cswap(z2, z3, swap);
+        swap = b;
+
+        fe_sub(tmp0, x3, z3);
+        fe_sub(tmp1, x2, z2);
+        fe_add(x2, x2, z2);
+        fe_add(z2, x3, z3);
+        fe_mul(z3, tmp0, x2);
+        fe_mul(z2, z2, tmp1);
+        fe_sq(tmp0, tmp1);
+        fe_sq(tmp1, x2);
+        fe_add(x3, z3, z2);
+        fe_sub(z2, z3, z2);
+        fe_mul(x2, tmp1, tmp0);
+        fe_sub(tmp1, tmp1, tmp0);
+        fe_sq(z2, z2);
+        fe_mul121666(z3, tmp1);
+        fe_sq(x3, x3);
+        fe_add(tmp0, tmp0, z3);
+        fe_mul(z3, x1, z2);
+        fe_mul(z2, tmp1, tmp0);
+    }
+
+    fe_cswap(x2, x3, swap);
+    fe_cswap(z2, z3, swap);
+
+    fe_invert(z2, z2);
+    fe_mul(x2, x2, z2);
+    fe_tobytes(shared_secret, x2);
+
+    wipe(e, sizeof(e));
+    wipe(x2, sizeof(fe));
+    wipe(x3, sizeof(fe));
+    wipe(z2, sizeof(fe));
+    wipe(z3, sizeof(fe));
+}
+
+void ed25519_public_key_to_x25519(unsigned char *exchange_key, const unsigned char *public_key)
+{
+    fe y, numerator, denominator;
+
+    fe_frombytes(y, public_key);
+    fe_1(denominator);
+    fe_add(numerator, y, denominator);
+    fe_sub(denominator, denominator, y);
+    fe_invert(denominator, denominator);
+    fe_mul(numerator, numerator, denominator);
+    fe_tobytes(exchange_key, numerator);
+}
+
+void ed25519_public_keys_to_x25519(unsigned char *exchange_keys, const unsigned char *public_keys, size_t count)
+{
+    fe numerators[ED25519_X25519_BATCH];
+    fe denominators[ED25519_X25519_BATCH];
+    fe products[ED25519_X25519_BATCH];
+    unsigned char is_zero[ED25519_X25519_BATCH];
+    fe y, one, inverse, recip;
+    size_t first, n, i;
+
+    fe_1(one);
+
+    for (first = 0; first < count; first += n) {
+        n = count - first < ED25519_X25519_BATCH ? count - first : ED25519_X25519_BATCH;
+
+        for (i = 0; i < n; ++i) {
+            fe_frombytes(y, public_keys + 32 * (first + i));
+            fe_add(numerators[i], y, one);
+            fe_sub(denominators[i], one, y);
+
+            /* y = 1 inverts zero to zero in the single conversion, it must not zero the whole batch */
+            is_zero[i] = !fe_isnonzero(denominators[i]);
+            if (is_zero[i]) fe_1(denominators[i]);
+        }
+
+        /* Montgomery's trick as of ed25519_create_keypairs */
+        fe_copy(products[0], denominators[0]);
+        for (i = 1; i < n; ++i)
+            fe_mul(products[i], products[i - 1], denominators[i]);
+
+        fe_invert(inverse, products[n - 1]);
+
+        for (i = n; i-- > 0; ) {
+            if (i > 0) {
+                fe_mul(recip, inverse, products[i - 1]);
+                fe_mul(inverse, inverse, denominators[i]);
+            }
+            else {
+                fe_copy(recip, inverse);
+            }
+
+            if (is_zero[i]) fe_0(recip);
+
+            fe_mul(y, numerators[i], recip);
+            fe_tobytes(exchange_keys + 32 * (first + i), y);
+        }
+    }
+}
+
+int ed25519_scalar_is_canonical(const unsigned char *scalar)
+{
+    /* L = 2^252 + 27742317777372353535851937790883648493, little endian */
+    static const unsigned char L[32] = {
+        0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+    };
+    int i;
+
+    for (i = 31; i >= 0; --i) {
+        if (scalar[i] < L[i]) return 1;
+        if (scalar[i] > L[i]) return 0;
+    }
+
+    return 0;
+}
+
+int ed25519_public_key_is_valid(const unsigned char *public_key)
+{
+    ge_p3 A;
+    int i;
+
+    /* p = 2^255 - 19: y >= p is ff..ff7f with a low byte from 0xed */
+    if ((public_key[31] & 0x7f) == 0x7f && public_key[0] >= 0xed) {
+        for (i = 1; i < 31 && public_key[i] == 0xff; ++i) {}
+        if (i == 31) return 0;
+    }
+
+    return ge_frombytes_negate_vartime(&A, public_key) == 0;
+}
@@ -1,6 +1,57 @@
 #ifndef ED25519_EXT_H
 #define ED25519_EXT_H
 
+#include <stddef.h>
+
+/* pairs created by ed25519_create_keypairs per shared field inversion */
+#define ED25519_KEYPAIRS_BATCH 64
+
+/* children derived by ed25519_derive_public_keys per shared field inversion */
+#define ED25519_DERIVE_BATCH 64
+
+/* size of a public key prepared by ed25519_prepare_public_key, the cached form of the point */
+#define ED25519_PREPARED_KEY_SIZE 160
+
+/* keys converted by ed25519_public_keys_to_x25519 per shared field inversion */
+#define ED25519_X25519_BATCH 64
+
 void ed25519_restore_from_private_key(unsigned char *public_key, const unsigned char *private_key);
 
-#endif
\ No newline at end of file
+/* ed25519_create_keypair of count seeds, the point encodings of a batch share one field inversion */
+void ed25519_create_keypairs(unsigned char *public_keys, unsigned char *private_keys,
+                             const unsigned char *seeds, size_t count);
+
+/* First half of ed25519_verify: h = SHA-512(R || A || M) mod L, 32 bytes */
+void ed25519_verify_hash(unsigned char *h, const unsigned char *signature, const unsigned char *public_key,
+                         const unsigned char *message, size_t message_len);
+
+/* Second half of ed25519_verify: 1 if R = sB - hA, equal to ed25519_verify of the message of h */
+int ed25519_verify_hashed(const unsigned char *signature, const unsigned char *public_key, const unsigned char *h);
+
+/* Decompress the public key once for ed25519_derive_public_keys, returns 0 if it is not a point */
+int ed25519_prepare_public_key(unsigned char *prepared, const unsigned char *public_key);
+
+/* ed25519_add_scalar without private key of count scalars over the prepared public key,
+   the encodings of a batch share one field inversion */
+void ed25519_derive_public_keys(unsigned char *public_keys, const unsigned char *prepared,
+                                const unsigned char *scalars, size_t count);
+
+/* X25519 public key (RFC 7748 Montgomery u) of the clamped private key, computed with the Edwards fixed-base table */
+void ed25519_x25519_public_key(unsigned char *public_key, const unsigned char *private_key);
+
+/* X25519 (RFC 7748): ladder of the clamped private key over the Montgomery u of public_key */
+void ed25519_x25519(unsigned char *shared_secret, const unsigned char *public_key, const unsigned char *private_key);
+
+/* Montgomery u = (1 + y) / (1 - y) of an Edwards public key, as ed25519_key_exchange converts the peer key */
+void ed25519_public_key_to_x25519(unsigned char *exchange_key, const unsigned char *public_key);
+
+/* ed25519_public_key_to_x25519 of count keys, the conversions of a batch share one field inversion */
+void ed25519_public_keys_to_x25519(unsigned char *exchange_keys, const unsigned char *public_keys, size_t count);
+
+/* 1 if the 32-byte little-endian scalar is less than the group order L */
+int ed25519_scalar_is_canonical(const unsigned char *scalar);
+
+/* 1 if the y coordinate is less than p and the point is on the curve */
+int ed25519_public_key_is_valid(const unsigned char *public_key);
+
+#endif
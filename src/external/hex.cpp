@@ -0,0 +1,204 @@
+//
+// Hex codec with nibble shuffles.
+//
+// Encoding splits every byte into nibbles and maps them with a 16-byte
+// "0123456789abcdef" shuffle table, the high and low characters are then
+// interleaved. Decoding classifies characters as digits or letters with
+// unsigned range checks, the nibble pairs are merged by a multiply-add
+// (16 * high + low) and packed back to bytes.
+//
+
+#include <array>
+#include <stdint.h>
+#include "hex.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HEX_X86 1
+#include <immintrin.h>
+#else
+#define HEX_X86 0
+#endif
+
+namespace {
+
+    constexpr const char digits[] = "0123456789abcdef";
+
+    /* encode_table[b]: two characters of byte b */
+    constexpr std::array<std::array<char, 2>, 256> make_encode_table() {
+        std::array<std::array<char, 2>, 256> table{};
+        for (size_t i = 0; i < 256; i++) {
+            table[i][0] = digits[i >> 4];
+            table[i][1] = digits[i & 0x0f];
+        }
+        return table;
+    }
+
+    /* decode_table[c]: nibble of character c, -1 for other characters */
+    constexpr std::array<int8_t, 256> make_decode_table() {
+        std::array<int8_t, 256> table{};
+        for (size_t i = 0; i < 256; i++) {
+            if (i >= '0' && i <= '9') table[i] = static_cast<int8_t>(i - '0');
+            else if (i >= 'a' && i <= 'f') table[i] = static_cast<int8_t>(i - 'a' + 10);
+            else if (i >= 'A' && i <= 'F') table[i] = static_cast<int8_t>(i - 'A' + 10);
+            else table[i] = -1;
+        }
+        return table;
+    }
+
+    constexpr auto encode_table = make_encode_table();
+    constexpr auto decode_table = make_decode_table();
+
+    void table_encode(const unsigned char *in, size_t len, char *out) {
+        for (size_t i = 0; i < len; i++) {
+            out[2 * i]     = encode_table[in[i]][0];
+            out[2 * i + 1] = encode_table[in[i]][1];
+        }
+    }
+
+    size_t table_decode(const char *in, size_t len, unsigned char *out) {
+        for (size_t i = 0; i < len; i++) {
+            int hi = decode_table[static_cast<unsigned char>(in[2 * i])];
+            int lo = decode_table[static_cast<unsigned char>(in[2 * i + 1])];
+            if ((hi | lo) < 0)
+                return i;
+            out[i] = static_cast<unsigned char>((hi << 4) | lo);
+        }
+        return len;
+    }
+
+#if HEX_X86
+
+    __attribute__((target("ssse3")))
+    size_t ssse3_encode(const unsigned char *in, size_t len, char *out) {
+        const __m128i lut = _mm_loadu_si128((const __m128i *) digits);
+        const __m128i mask = _mm_set1_epi8(0x0f);
+        size_t done = 0;
+        for (; done + 16 <= len; done += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (in + done));
+            __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+            __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+            _mm_storeu_si128((__m128i *) (out + 2 * done), _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128((__m128i *) (out + 2 * done + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+        return done;
+    }
+
+    __attribute__((target("avx2")))
+    size_t avx2_encode(const unsigned char *in, size_t len, char *out) {
+        const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) digits));
+        const __m256i mask = _mm256_set1_epi8(0x0f);
+        size_t done = 0;
+        for (; done + 32 <= len; done += 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *) (in + done));
+            __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+            __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+            /* in-lane interleave: bytes 0-7 | 16-23 and 8-15 | 24-31 */
+            __m256i a = _mm256_unpacklo_epi8(hi, lo);
+            __m256i b = _mm256_unpackhi_epi8(hi, lo);
+            _mm256_storeu_si256((__m256i *) (out + 2 * done), _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256((__m256i *) (out + 2 * done + 32), _mm256_permute2x128_si256(a, b, 0x31));
+        }
+        return done;
+    }
+
+    /* nibbles of 16 characters, valid is all ones for hex characters */
+    __attribute__((target("ssse3")))
+    inline __m128i ssse3_nibbles(__m128i c, __m128i &valid) {
+        __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+        valid = _mm_or_si128(is_digit, is_letter);
+        return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                            _mm_andnot_si128(is_digit, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+    }
+
+    __attribute__((target("ssse3")))
+    size_t ssse3_decode(const char *in, size_t len, unsigned char *out) {
+        const __m128i weights = _mm_set1_epi16(0x0110);
+        size_t done = 0;
+        for (; done + 16 <= len; done += 16) {
+            __m128i valid0, valid1;
+            __m128i n0 = ssse3_nibbles(_mm_loadu_si128((const __m128i *) (in + 2 * done)), valid0);
+            __m128i n1 = ssse3_nibbles(_mm_loadu_si128((const __m128i *) (in + 2 * done + 16)), valid1);
+            if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xffff)
+                break;
+            /* 16 * high + low of every character pair */
+            __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(n0, weights), _mm_maddubs_epi16(n1, weights));
+            _mm_storeu_si128((__m128i *) (out + done), bytes);
+        }
+        return done;
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i avx2_nibbles(__m256i c, __m256i &valid) {
+        __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+        __m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+        valid = _mm256_or_si256(is_digit, is_letter);
+        return _mm256_blendv_epi8(_mm256_add_epi8(letter, _mm256_set1_epi8(10)), digit, is_digit);
+    }
+
+    __attribute__((target("avx2")))
+    size_t avx2_decode(const char *in, size_t len, unsigned char *out) {
+        const __m256i weights = _mm256_set1_epi16(0x0110);
+        size_t done = 0;
+        for (; done + 32 <= len; done += 32) {
+            __m256i valid0, valid1;
+            __m256i n0 = avx2_nibbles(_mm256_loadu_si256((const __m256i *) (in + 2 * done)), valid0);
+            __m256i n1 = avx2_nibbles(_mm256_loadu_si256((const __m256i *) (in + 2 * done + 32)), valid1);
+            if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1)
+                break;
+            /* packing is in-lane: 64-bit quarters come out as 0, 2, 1, 3 */
+            __m256i bytes = _mm256_packus_epi16(_mm256_maddubs_epi16(n0, weights), _mm256_maddubs_epi16(n1, weights));
+            _mm256_storeu_si256((__m256i *) (out + done), _mm256_permute4x64_epi64(bytes, 0xd8));
+        }
+        return done;
+    }
+
+    enum class level { table, ssse3, avx2 };
+
+    level simd_level() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return level::avx2;
+        if (__builtin_cpu_supports("ssse3")) return level::ssse3;
+        return level::table;
+    }
+
+#endif
+}
+
+/* *************************** Public Inteface ************************ */
+
+void hex_encode(const unsigned char *in, size_t len, char *out) {
+    size_t done = 0;
+
+#if HEX_X86
+    static const level simd = simd_level();
+    if (simd == level::avx2) done = avx2_encode(in, len, out);
+    else if (simd == level::ssse3) done = ssse3_encode(in, len, out);
+#endif
+
+    table_encode(in + done, len - done, out + 2 * done);
+}
+
+size_t hex_decode(const char *in, size_t len, unsigned char *out) {
+    size_t done = 0;
+
+#if HEX_X86
+    static const level simd = simd_level();
+    if (simd == level::avx2) done = avx2_decode(in, len, out);
+    else if (simd == level::ssse3) done = ssse3_decode(in, len, out);
+#endif
+
+    return done + table_decode(in + 2 * done, len - done, out + done);
+}
+
+void hex_encode_table(const unsigned char *in, size_t len, char *out) {
+    table_encode(in, len, out);
+}
+
+size_t hex_decode_table(const char *in, size_t len, unsigned char *out) {
+    return table_decode(in, len, out);
+}
@@ -0,0 +1,32 @@
+//
+// Hex (base16) codec.
+//
+// Nibbles are converted with byte shuffles, 32 bytes at a time with AVX2,
+// 16 with SSSE3, through 256-entry tables otherwise. No iostreams.
+//
+
+#ifndef _HEX_H
+#define _HEX_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Lowercase hex of len bytes, out receives 2 * len characters */
+void hex_encode(const unsigned char *in, size_t len, char *out);
+
+/* Decode len bytes from 2 * len characters of either case, returns the number
+ * of bytes decoded before the first pair with a non-hex character */
+size_t hex_decode(const char *in, size_t len, unsigned char *out);
+
+/* Table-driven paths only, the reference for the SIMD paths */
+void hex_encode_table(const unsigned char *in, size_t len, char *out);
+size_t hex_decode_table(const char *in, size_t len, unsigned char *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
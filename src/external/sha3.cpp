@@ -151,6 +151,18 @@ sha3_Init512(void *priv)
     ctx->numOutputBytes = 64;
 }
 
+/* Little-endian 64-bit load from an unaligned buffer */
+static inline uint64_t
+sha3_load64(const uint8_t *buf)
+{
+    uint64_t t;
+    memcpy(&t, buf, sizeof(t));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    t = __builtin_bswap64(t);
+#endif
+    return t;
+}
+
 void
 sha3_Update(void *priv, void const *bufIn, size_t len)
 {
@@ -159,9 +171,11 @@ sha3_Update(void *priv, void const *bufIn, size_t len)
     /* 0...7 -- how much is needed to have a word */
     unsigned old_tail = (8 - ctx->byteIndex) & 7;
     
-    size_t words;
+    /* words in a rate-sized block, 17 for SHA3-256 */
+    const unsigned rateWords = SHA3_KECCAK_SPONGE_WORDS - ctx->capacityWords;
+    
     unsigned tail;
-    size_t i;
+    unsigned i;
 
     const uint8_t *buf = (const uint8_t*) bufIn;
     
@@ -193,8 +207,7 @@ sha3_Update(void *priv, void const *bufIn, size_t len)
         SHA3_ASSERT(ctx->byteIndex == 8);
         ctx->byteIndex = 0;
         ctx->saved = 0;
-        if(++ctx->wordIndex ==
-           (SHA3_KECCAK_SPONGE_WORDS - ctx->capacityWords)) {
+        if(++ctx->wordIndex == rateWords) {
             keccakf(ctx->s);
             ctx->wordIndex = 0;
         }
@@ -204,31 +217,40 @@ sha3_Update(void *priv, void const *bufIn, size_t len)
     
     SHA3_ASSERT(ctx->byteIndex == 0);
     
-    words = len / sizeof(uint64_t);
-    tail = (unsigned)(len - words * sizeof(uint64_t));
-    
-    SHA3_TRACE("have %d full words to process", (unsigned)words);
-    
-    for(i = 0; i < words; i++, buf += sizeof(uint64_t)) {
-        const uint64_t t = (uint64_t) (buf[0]) |
-        ((uint64_t) (buf[1]) << 8 * 1) |
-        ((uint64_t) (buf[2]) << 8 * 2) |
-        ((uint64_t) (buf[3]) << 8 * 3) |
-        ((uint64_t) (buf[4]) << 8 * 4) |
-        ((uint64_t) (buf[5]) << 8 * 5) |
-        ((uint64_t) (buf[6]) << 8 * 6) |
-        ((uint64_t) (buf[7]) << 8 * 7);
-#if defined(__x86_64__ ) || defined(__i386__)
-        SHA3_ASSERT(memcmp(&t, buf, 8) == 0);
-#endif
-        ctx->s[ctx->wordIndex] ^= t;
-        if(++ctx->wordIndex ==
-           (SHA3_KECCAK_SPONGE_WORDS - ctx->capacityWords)) {
+    /* finish the block started by a previous call word by word */
+    while(ctx->wordIndex != 0 && len >= sizeof(uint64_t)) {
+        ctx->s[ctx->wordIndex] ^= sha3_load64(buf);
+        buf += sizeof(uint64_t);
+        len -= sizeof(uint64_t);
+        if(++ctx->wordIndex == rateWords) {
             keccakf(ctx->s);
             ctx->wordIndex = 0;
         }
     }
     
+    /* the sponge is at a block boundary: absorb whole blocks in bulk */
+    if(ctx->wordIndex == 0) {
+        SHA3_TRACE("have %d full blocks to process",
+                   (unsigned)(len / (rateWords * sizeof(uint64_t))));
+        while(len >= rateWords * sizeof(uint64_t)) {
+            for(i = 0; i < rateWords; i++)
+                ctx->s[i] ^= sha3_load64(buf + i * sizeof(uint64_t));
+            keccakf(ctx->s);
+            buf += rateWords * sizeof(uint64_t);
+            len -= rateWords * sizeof(uint64_t);
+        }
+    }
+    
+    /* less than a block is left, no permutation is needed */
+    while(len >= sizeof(uint64_t)) {
+        SHA3_ASSERT(ctx->wordIndex < rateWords);
+        ctx->s[ctx->wordIndex++] ^= sha3_load64(buf);
+        buf += sizeof(uint64_t);
+        len -= sizeof(uint64_t);
+    }
+    
+    tail = (unsigned)len;
+    
     SHA3_TRACE("have %d bytes left to process, save them", (unsigned)tail);
     
     /* finally, save the partial word */
@@ -302,6 +324,34 @@ void sha3_Finalize(void *priv, unsigned char *out)
 }
 
 
+/* Finalize with an arbitrary domain suffix and output length: the suffix
+ * carries the domain bits followed by the first padding bit, 0x06 for SHA3,
+ * 0x1F for SHAKE and 0x04 for cSHAKE. Output longer than the rate is
+ * squeezed with extra permutations.
+ */
+void sha3_FinalizeXof(void *priv, unsigned char suffix, unsigned char *out, size_t out_len)
+{
+    sha3_context *ctx = (sha3_context *) priv;
+    const unsigned rateBytes =
+    (SHA3_KECCAK_SPONGE_WORDS - ctx->capacityWords) * sizeof(uint64_t);
+    size_t i, n;
+    
+    ctx->s[ctx->wordIndex] ^=
+    (ctx->saved ^ ((uint64_t) suffix << ((ctx->byteIndex) * 8)));
+    ctx->s[SHA3_KECCAK_SPONGE_WORDS - ctx->capacityWords - 1] ^=
+    SHA3_CONST(0x8000000000000000UL);
+    
+    for(;;) {
+        keccakf(ctx->s);
+        n = out_len < rateBytes ? out_len : rateBytes;
+        for(i = 0; i < n; i++)
+            *(out++) = (unsigned char) (ctx->s[i / 8] >> (8 * (i % 8)));
+        out_len -= n;
+        if(out_len == 0)
+            break;
+    }
+}
+
 void sha3_256(const unsigned char *message, size_t message_len, unsigned char *out) {
     sha3_context ctx;
     
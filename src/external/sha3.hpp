@@ -49,6 +49,7 @@ void sha3_Init384(void *priv);
 void sha3_Init512(void *priv);
 void sha3_Update(void *priv, void const *bufIn, size_t len);
 void sha3_Finalize(void *priv, unsigned char *out);
+void sha3_FinalizeXof(void *priv, unsigned char suffix, unsigned char *out, size_t out_len);
 void sha3_256(const unsigned char *message, size_t message_len, unsigned char *out);
 void sha3_384(const unsigned char *message, size_t message_len, unsigned char *out);
 void sha3_512(const unsigned char *message, size_t message_len, unsigned char *out);
@@ -0,0 +1,281 @@
+//
+// Multi-buffer SHA3-256 and SHAKE256 (both have the 136-byte rate).
+//
+// The state of every message lives in one column of st[25][SHA3_LANES_MAX],
+// so a row st[i] is exactly one SIMD register of AVX-512 (8 lanes) or the
+// first half of it for AVX2 (4 lanes). Messages of a group can differ in
+// length: a lane whose padded input is over keeps being permuted with the
+// others, but its digest is squeezed right after its last block.
+//
+
+#include <string.h>
+#include "sha3.hpp"
+#include "sha3_lanes.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SHA3_LANES_X86 1
+#include <immintrin.h>
+#else
+#define SHA3_LANES_X86 0
+#endif
+
+/* SHA3-256 rate: 1600 - 2*256 bits */
+#define SHA3_256_RATE 136
+#define SHA3_256_RATE_WORDS (SHA3_256_RATE / 8)
+
+typedef uint64_t sha3_lanes_state[25][SHA3_LANES_MAX];
+typedef void (*sha3_lanes_permute)(sha3_lanes_state);
+
+#if SHA3_LANES_X86
+
+static const uint64_t lanes_rndc[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+    0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+/* rho offsets indexed by x + 5*y */
+static const unsigned lanes_rho[25] = {
+     0,  1, 62, 28, 27,
+    36, 44,  6, 55, 20,
+     3, 10, 43, 25, 39,
+    41, 45, 15, 21,  8,
+    18,  2, 61, 56, 14
+};
+
+__attribute__((target("avx2")))
+static inline __m256i rol_x4(__m256i x, unsigned n) {
+    if (n == 0)
+        return x;
+    return _mm256_or_si256(_mm256_sll_epi64(x, _mm_cvtsi32_si128((int) n)),
+                           _mm256_srl_epi64(x, _mm_cvtsi32_si128((int) (64 - n))));
+}
+
+__attribute__((target("avx2")))
+static void keccakf_x4(sha3_lanes_state st) {
+    __m256i a[25], b[25], c[5], d;
+    int i, x, y, round;
+
+    for (i = 0; i < 25; i++)
+        a[i] = _mm256_load_si256((const __m256i *) st[i]);
+
+    for (round = 0; round < 24; round++) {
+        /* Theta */
+        for (x = 0; x < 5; x++)
+            c[x] = _mm256_xor_si256(_mm256_xor_si256(a[x], a[x + 5]),
+                                    _mm256_xor_si256(_mm256_xor_si256(a[x + 10], a[x + 15]), a[x + 20]));
+        for (x = 0; x < 5; x++) {
+            d = _mm256_xor_si256(c[(x + 4) % 5], rol_x4(c[(x + 1) % 5], 1));
+            for (y = 0; y < 25; y += 5)
+                a[x + y] = _mm256_xor_si256(a[x + y], d);
+        }
+
+        /* Rho Pi */
+        for (x = 0; x < 5; x++)
+            for (y = 0; y < 5; y++)
+                b[y + 5 * ((2 * x + 3 * y) % 5)] = rol_x4(a[x + 5 * y], lanes_rho[x + 5 * y]);
+
+        /* Chi */
+        for (y = 0; y < 25; y += 5)
+            for (x = 0; x < 5; x++)
+                a[x + y] = _mm256_xor_si256(b[x + y],
+                                            _mm256_andnot_si256(b[(x + 1) % 5 + y], b[(x + 2) % 5 + y]));
+
+        /* Iota */
+        a[0] = _mm256_xor_si256(a[0], _mm256_set1_epi64x((long long) lanes_rndc[round]));
+    }
+
+    for (i = 0; i < 25; i++)
+        _mm256_store_si256((__m256i *) st[i], a[i]);
+}
+
+/* GCC 12 reports its own _mm512_undefined_* placeholders as uninitialized */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+__attribute__((target("avx512f")))
+static void keccakf_x8(sha3_lanes_state st) {
+    __m512i a[25], b[25], c[5], d;
+    int i, x, y, round;
+
+    for (i = 0; i < 25; i++)
+        a[i] = _mm512_load_si512((const void *) st[i]);
+
+    for (round = 0; round < 24; round++) {
+        /* Theta */
+        for (x = 0; x < 5; x++)
+            c[x] = _mm512_ternarylogic_epi64(_mm512_ternarylogic_epi64(a[x], a[x + 5], a[x + 10], 0x96),
+                                             a[x + 15], a[x + 20], 0x96);
+        for (x = 0; x < 5; x++) {
+            d = _mm512_xor_si512(c[(x + 4) % 5], _mm512_rol_epi64(c[(x + 1) % 5], 1));
+            for (y = 0; y < 25; y += 5)
+                a[x + y] = _mm512_xor_si512(a[x + y], d);
+        }
+
+        /* Rho Pi */
+        for (x = 0; x < 5; x++)
+            for (y = 0; y < 5; y++)
+                b[y + 5 * ((2 * x + 3 * y) % 5)] =
+                        _mm512_rolv_epi64(a[x + 5 * y], _mm512_set1_epi64((long long) lanes_rho[x + 5 * y]));
+
+        /* Chi: b0 ^ (~b1 & b2) */
+        for (y = 0; y < 25; y += 5)
+            for (x = 0; x < 5; x++)
+                a[x + y] = _mm512_ternarylogic_epi64(b[x + y], b[(x + 1) % 5 + y], b[(x + 2) % 5 + y], 0xD2);
+
+        /* Iota */
+        a[0] = _mm512_xor_si512(a[0], _mm512_set1_epi64((long long) lanes_rndc[round]));
+    }
+
+    for (i = 0; i < 25; i++)
+        _mm512_store_si512((void *) st[i], a[i]);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+static unsigned sha3_lanes_detect(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return 8;
+    if (__builtin_cpu_supports("avx2"))
+        return 4;
+    return 1;
+}
+
+static inline uint64_t load64_le(const unsigned char *p) {
+    uint64_t t;
+    memcpy(&t, p, sizeof(t));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    t = __builtin_bswap64(t);
+#endif
+    return t;
+}
+
+static void absorb_block(sha3_lanes_state st, unsigned lane, const unsigned char *block) {
+    unsigned w;
+    for (w = 0; w < SHA3_256_RATE_WORDS; w++)
+        st[w][lane] ^= load64_le(block + w * 8);
+}
+
+static void squeeze_lane(const sha3_lanes_state st, unsigned lane, unsigned char *out, size_t out_len) {
+    size_t i;
+    for (i = 0; i < out_len; i++)
+        out[i] = (unsigned char) (st[i / 8][lane] >> (8 * (i % 8)));
+}
+
+static void sponge_group(const unsigned char *const *messages,
+                           const size_t *message_lens,
+                           unsigned count,
+                           unsigned char *const *out,
+                           unsigned char suffix,
+                           size_t out_len,
+                           sha3_lanes_permute permute) {
+    alignas(64) sha3_lanes_state st;
+    unsigned char last[SHA3_256_RATE];
+    size_t blocks[SHA3_LANES_MAX];
+    size_t max_blocks = 0, b;
+    unsigned i;
+
+    memset(st, 0, sizeof(st));
+
+    for (i = 0; i < count; i++) {
+        /* the padding always takes at least one byte, so there is one more block */
+        blocks[i] = message_lens[i] / SHA3_256_RATE + 1;
+        if (blocks[i] > max_blocks)
+            max_blocks = blocks[i];
+    }
+
+    for (b = 0; b < max_blocks; b++) {
+        for (i = 0; i < count; i++) {
+            if (b + 1 < blocks[i]) {
+                absorb_block(st, i, messages[i] + b * SHA3_256_RATE);
+            } else if (b + 1 == blocks[i]) {
+                size_t rest = message_lens[i] - b * SHA3_256_RATE;
+                memset(last, 0, sizeof(last));
+                if (rest)
+                    memcpy(last, messages[i] + b * SHA3_256_RATE, rest);
+                /* domain suffix followed by pad10*1 */
+                last[rest] ^= suffix;
+                last[SHA3_256_RATE - 1] ^= 0x80;
+                absorb_block(st, i, last);
+            }
+        }
+
+        permute(st);
+
+        for (i = 0; i < count; i++) {
+            if (b + 1 == blocks[i])
+                squeeze_lane(st, i, out[i], out_len);
+        }
+    }
+}
+
+#endif
+
+/* *************************** Public Inteface ************************ */
+
+unsigned sha3_lanes(void) {
+#if SHA3_LANES_X86
+    static const unsigned lanes = sha3_lanes_detect();
+    return lanes;
+#else
+    return 1;
+#endif
+}
+
+static void sponge_lanes(const unsigned char *const *messages,
+                         const size_t *message_lens,
+                         size_t count,
+                         unsigned char *const *out,
+                         unsigned char suffix,
+                         size_t out_len) {
+    size_t i = 0;
+
+#if SHA3_LANES_X86
+    unsigned lanes = sha3_lanes();
+
+    /* a single leftover message is cheaper on the scalar path */
+    while (lanes > 1 && count - i >= 2) {
+        size_t n = count - i;
+        if (lanes >= 8 && n > 4) {
+            n = n < 8 ? n : 8;
+            sponge_group(messages + i, message_lens + i, (unsigned) n, out + i, suffix, out_len, keccakf_x8);
+        } else {
+            n = n < 4 ? n : 4;
+            sponge_group(messages + i, message_lens + i, (unsigned) n, out + i, suffix, out_len, keccakf_x4);
+        }
+        i += n;
+    }
+#endif
+
+    for (; i < count; i++) {
+        sha3_context ctx;
+        sha3_Init256(&ctx);
+        sha3_Update(&ctx, messages[i], message_lens[i]);
+        sha3_FinalizeXof(&ctx, suffix, out[i], out_len);
+    }
+}
+
+void sha3_256_lanes(const unsigned char *const *messages,
+                    const size_t *message_lens,
+                    size_t count,
+                    unsigned char *const *out) {
+    sponge_lanes(messages, message_lens, count, out, 0x06, 32);
+}
+
+void shake256_lanes(const unsigned char *const *messages,
+                    const size_t *message_lens,
+                    size_t count,
+                    unsigned char *const *out,
+                    size_t out_len) {
+    sponge_lanes(messages, message_lens, count, out, 0x1F, out_len);
+}
@@ -0,0 +1,41 @@
+//
+// Multi-buffer SHA3-256 and SHAKE256: several independent Keccak states
+// permuted in parallel SIMD lanes.
+//
+
+#ifndef _SHA3_LANES_H
+#define _SHA3_LANES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA3_LANES_MAX 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of Keccak states the running CPU permutes at once:
+ * 8 (AVX-512), 4 (AVX2) or 1 (portable sha3.cpp path) */
+unsigned sha3_lanes(void);
+
+/* SHA3-256 of count independent messages, out[i] receives 32 bytes
+ * of messages[i]. Results are identical to sha3_256(). */
+void sha3_256_lanes(const unsigned char *const *messages,
+                    const size_t *message_lens,
+                    size_t count,
+                    unsigned char *const *out);
+
+/* SHAKE256 of count independent messages, out[i] receives out_len bytes,
+ * out_len must not exceed the 136-byte rate */
+void shake256_lanes(const unsigned char *const *messages,
+                    const size_t *message_lens,
+                    size_t count,
+                    unsigned char *const *out,
+                    size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
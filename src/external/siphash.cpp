@@ -0,0 +1,92 @@
+//
+// SipHash-2-4 (Aumasson, Bernstein), 128-bit output variant of the reference implementation.
+//
+
+#include <string.h>
+#include "siphash.hpp"
+
+namespace {
+
+    inline uint64_t rotl(uint64_t x, int b) { return (x << b) | (x >> (64 - b)); }
+
+    inline uint64_t load64_le(const unsigned char *p) {
+        uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+        return v;
+    }
+
+    inline void store64_le(unsigned char *p, uint64_t v) {
+        for (int i = 0; i < 8; ++i) p[i] = (unsigned char) (v >> (8 * i));
+    }
+
+    inline void round(siphash_state *s) {
+        s->v0 += s->v1; s->v1 = rotl(s->v1, 13); s->v1 ^= s->v0; s->v0 = rotl(s->v0, 32);
+        s->v2 += s->v3; s->v3 = rotl(s->v3, 16); s->v3 ^= s->v2;
+        s->v0 += s->v3; s->v3 = rotl(s->v3, 21); s->v3 ^= s->v0;
+        s->v2 += s->v1; s->v1 = rotl(s->v1, 17); s->v1 ^= s->v2; s->v2 = rotl(s->v2, 32);
+    }
+
+    inline void compress(siphash_state *s, uint64_t m) {
+        s->v3 ^= m;
+        round(s);
+        round(s);
+        s->v0 ^= m;
+    }
+}
+
+/* *************************** Public Inteface ************************ */
+
+void siphash128_init(siphash_state *state, const unsigned char key[16]) {
+    uint64_t k0 = load64_le(key);
+    uint64_t k1 = load64_le(key + 8);
+
+    state->v0 = 0x736f6d6570736575ULL ^ k0;
+    state->v1 = 0x646f72616e646f6dULL ^ k1 ^ 0xee;
+    state->v2 = 0x6c7967656e657261ULL ^ k0;
+    state->v3 = 0x7465646279746573ULL ^ k1;
+    state->tail = 0;
+    state->length = 0;
+}
+
+void siphash_update(siphash_state *state, const unsigned char *in, size_t len) {
+    size_t used = state->length & 7;
+    state->length += len;
+
+    if (used) {
+        while (used < 8 && len > 0) {
+            state->tail |= (uint64_t) *in++ << (8 * used++);
+            --len;
+        }
+        if (used < 8)
+            return;
+        compress(state, state->tail);
+        state->tail = 0;
+    }
+
+    for (; len >= 8; in += 8, len -= 8)
+        compress(state, load64_le(in));
+
+    for (size_t i = 0; i < len; ++i)
+        state->tail |= (uint64_t) in[i] << (8 * i);
+}
+
+void siphash128_final(siphash_state *state, unsigned char out[16]) {
+    compress(state, state->tail | ((uint64_t) (state->length & 0xff) << 56));
+
+    state->v2 ^= 0xee;
+    for (int i = 0; i < 4; ++i) round(state);
+    store64_le(out, state->v0 ^ state->v1 ^ state->v2 ^ state->v3);
+
+    state->v1 ^= 0xdd;
+    for (int i = 0; i < 4; ++i) round(state);
+    store64_le(out + 8, state->v0 ^ state->v1 ^ state->v2 ^ state->v3);
+
+    memset(state, 0, sizeof(*state));
+}
+
+void siphash128(const unsigned char key[16], const unsigned char *in, size_t len, unsigned char out[16]) {
+    siphash_state state;
+    siphash128_init(&state, key);
+    siphash_update(&state, in, len);
+    siphash128_final(&state, out);
+}
@@ -0,0 +1,37 @@
+//
+// SipHash-2-4 with 128-bit output, the keyed hash of verification cache tags.
+//
+
+#ifndef _SIPHASH_H
+#define _SIPHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t v0, v1, v2, v3;
+    uint64_t tail;
+    size_t length;
+} siphash_state;
+
+/* Start SipHash-2-4-128 with a 16-byte key */
+void siphash128_init(siphash_state *state, const unsigned char key[16]);
+
+/* Continue hashing over len bytes */
+void siphash_update(siphash_state *state, const unsigned char *in, size_t len);
+
+/* Finish hashing, out is the 16-byte little-endian result */
+void siphash128_final(siphash_state *state, unsigned char out[16]);
+
+/* SipHash-2-4-128 of in */
+void siphash128(const unsigned char key[16], const unsigned char *in, size_t len, unsigned char out[16]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
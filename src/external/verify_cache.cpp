@@ -0,0 +1,287 @@
+//
+// Lock-free 4-way set-associative table of verification tags.
+//
+// The current table is published through an atomic pointer. A thread marks
+// the table it reads in its own hazard record, so lookups and inserts take
+// no locks and share no reference count. A replaced table is freed once no
+// hazard record points to it, until then it waits in a retired list that is
+// scanned on every resize. Counters are sharded by hazard record.
+//
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <string.h>
+#include "siphash.hpp"
+#include "csprng.hpp"
+#include "verify_cache.hpp"
+
+namespace {
+
+    /* counter shards of a table, threads map to them by their hazard record */
+    constexpr size_t counter_shards = 16;
+
+    /* both halves of a tag, zero is an empty way */
+    struct way {
+        std::atomic<uint64_t> low;
+        std::atomic<uint64_t> high;
+    };
+
+    struct alignas(64) counters {
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+        std::atomic<uint64_t> insertions;
+    };
+
+    struct table {
+        unsigned char key[16];
+        size_t mask;
+        std::unique_ptr<way[]> ways;
+        counters shards[counter_shards];
+
+        explicit table(size_t entries): key{}, mask(0) {
+            size_t buckets = 1;
+            while (buckets * VERIFY_CACHE_WAYS < entries) buckets <<= 1;
+            mask = buckets - 1;
+            ways.reset(new (std::nothrow) way[buckets * VERIFY_CACHE_WAYS]);
+            if (ways)
+                clear();
+        }
+
+        ~table() {
+            volatile unsigned char *p = key;
+            for (size_t i = 0; i < sizeof(key); i++) p[i] = 0;
+        }
+
+        size_t capacity() const { return (mask + 1) * VERIFY_CACHE_WAYS; }
+
+        void clear() {
+            for (size_t i = 0; i < capacity(); ++i) {
+                ways[i].low.store(0, std::memory_order_relaxed);
+                ways[i].high.store(0, std::memory_order_relaxed);
+            }
+            for (auto &shard: shards) {
+                shard.hits.store(0, std::memory_order_relaxed);
+                shard.misses.store(0, std::memory_order_relaxed);
+                shard.insertions.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        way *bucket(uint64_t low) const { return &ways[(low & mask) * VERIFY_CACHE_WAYS]; }
+    };
+
+    /* table a thread reads, records are never freed and are reused after their thread exits */
+    struct alignas(64) hazard {
+        std::atomic<table *> pointer;
+        std::atomic<bool> active;
+        size_t shard;
+        hazard *next;
+    };
+
+    std::atomic<table *> current(nullptr);
+    std::atomic<hazard *> hazards(nullptr);
+    std::atomic<size_t> hazard_count(0);
+
+    /* resizes are serialized, tables still read by some thread wait in retired */
+    std::mutex writers;
+    std::vector<table *> retired;
+
+    hazard *acquire_hazard() {
+        for (hazard *h = hazards.load(std::memory_order_acquire); h; h = h->next) {
+            bool expected = false;
+            if (!h->active.load(std::memory_order_relaxed) &&
+                h->active.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return h;
+        }
+
+        auto h = new hazard();
+        h->pointer.store(nullptr, std::memory_order_relaxed);
+        h->active.store(true, std::memory_order_relaxed);
+        h->shard = hazard_count.fetch_add(1, std::memory_order_relaxed) % counter_shards;
+        h->next = hazards.load(std::memory_order_relaxed);
+        while (!hazards.compare_exchange_weak(h->next, h, std::memory_order_release, std::memory_order_relaxed));
+        return h;
+    }
+
+    struct hazard_slot {
+        hazard *record;
+
+        hazard_slot(): record(acquire_hazard()) {}
+
+        ~hazard_slot() {
+            record->pointer.store(nullptr, std::memory_order_release);
+            record->active.store(false, std::memory_order_release);
+        }
+    };
+
+    hazard *thread_hazard() {
+        thread_local hazard_slot slot;
+        return slot.record;
+    }
+
+    /* holds the current table against being freed until the guard is gone */
+    class guard {
+    public:
+        guard(): record_(thread_hazard()), table_(current.load(std::memory_order_acquire)) {
+            while (table_) {
+                record_->pointer.store(table_, std::memory_order_seq_cst);
+                table *again = current.load(std::memory_order_seq_cst);
+                if (again == table_) break;
+                table_ = again;
+            }
+        }
+
+        ~guard() {
+            record_->pointer.store(nullptr, std::memory_order_release);
+        }
+
+        guard(const guard &) = delete;
+        guard &operator=(const guard &) = delete;
+
+        table *get() const { return table_; }
+        counters &shard() const { return table_->shards[record_->shard]; }
+
+    private:
+        hazard *record_;
+        table *table_;
+    };
+
+    bool hazardous(const table *t) {
+        for (hazard *h = hazards.load(std::memory_order_acquire); h; h = h->next) {
+            if (h->pointer.load(std::memory_order_seq_cst) == t)
+                return true;
+        }
+        return false;
+    }
+
+    /* replaces the current table, frees every replaced table no thread reads any more; writers is held */
+    void publish(table *cache) {
+        table *old = current.exchange(cache, std::memory_order_seq_cst);
+        if (old) retired.push_back(old);
+
+        size_t kept = 0;
+        for (auto t: retired) {
+            if (hazardous(t))
+                retired[kept++] = t;
+            else
+                delete t;
+        }
+        retired.resize(kept);
+    }
+
+    void split(const unsigned char tag[VERIFY_CACHE_TAG_SIZE], uint64_t &low, uint64_t &high) {
+        memcpy(&low, tag, sizeof(low));
+        memcpy(&high, tag + 8, sizeof(high));
+        // zero marks an empty way
+        if ((low | high) == 0) low = 1;
+    }
+}
+
+/* *************************** Public Inteface ************************ */
+
+int verify_cache_resize(size_t entries) {
+    std::lock_guard<std::mutex> lock(writers);
+
+    if (entries == 0) {
+        publish(nullptr);
+        return 0;
+    }
+
+    table *cache = entries <= VERIFY_CACHE_MAX_ENTRIES ? new (std::nothrow) table(entries) : nullptr;
+    if (!cache || !cache->ways) {
+        delete cache;
+        publish(nullptr);
+        return 1;
+    }
+
+    // a predictable key would let tags of forged triples be searched for offline
+    if (csprng_bytes(cache->key, sizeof(cache->key)) != 0) {
+        delete cache;
+        publish(nullptr);
+        return 1;
+    }
+
+    publish(cache);
+    return 0;
+}
+
+void verify_cache_clear(void) {
+    guard cache;
+    if (cache.get())
+        cache.get()->clear();
+}
+
+void verify_cache_statistics(verify_cache_stats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    guard cache;
+    if (!cache.get())
+        return;
+    for (auto &shard: cache.get()->shards) {
+        stats->hits += shard.hits.load(std::memory_order_relaxed);
+        stats->misses += shard.misses.load(std::memory_order_relaxed);
+        stats->insertions += shard.insertions.load(std::memory_order_relaxed);
+    }
+    stats->capacity = cache.get()->capacity();
+}
+
+int verify_cache_lookup(unsigned char tag[VERIFY_CACHE_TAG_SIZE],
+                        const unsigned char *signature, const unsigned char *public_key,
+                        const unsigned char *message, size_t len) {
+    // a disabled cache costs one relaxed load per verification
+    if (!current.load(std::memory_order_relaxed))
+        return -1;
+
+    guard cache;
+    if (!cache.get())
+        return -1;
+
+    siphash_state state;
+    siphash128_init(&state, cache.get()->key);
+    siphash_update(&state, signature, 64);
+    siphash_update(&state, public_key, 32);
+    siphash_update(&state, message, len);
+    siphash128_final(&state, tag);
+
+    uint64_t low, high;
+    split(tag, low, high);
+
+    // halves are not read at once: a torn pair matches only if both halves belong to cached tags
+    way *bucket = cache.get()->bucket(low);
+    for (size_t i = 0; i < VERIFY_CACHE_WAYS; ++i) {
+        if (bucket[i].low.load(std::memory_order_relaxed) == low &&
+            bucket[i].high.load(std::memory_order_relaxed) == high) {
+            cache.shard().hits.fetch_add(1, std::memory_order_relaxed);
+            return 1;
+        }
+    }
+
+    cache.shard().misses.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+}
+
+void verify_cache_insert(const unsigned char tag[VERIFY_CACHE_TAG_SIZE]) {
+    guard cache;
+    if (!cache.get())
+        return;
+
+    uint64_t low, high;
+    split(tag, low, high);
+
+    // an empty way or the one picked by the tag, the tag is random
+    way *bucket = cache.get()->bucket(low);
+    way *victim = &bucket[high % VERIFY_CACHE_WAYS];
+    for (size_t i = 0; i < VERIFY_CACHE_WAYS; ++i) {
+        if (bucket[i].low.load(std::memory_order_relaxed) == 0) {
+            victim = &bucket[i];
+            break;
+        }
+    }
+
+    victim->low.store(0, std::memory_order_relaxed);
+    victim->high.store(high, std::memory_order_relaxed);
+    victim->low.store(low, std::memory_order_relaxed);
+
+    cache.shard().insertions.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,57 @@
+//
+// Bounded cache of successful signature verifications.
+//
+// A verification is remembered as a 16-byte tag, SipHash-2-4-128 of
+// signature || public key || message under a random key drawn when the cache
+// is sized. Tags live in a fixed table of 4-way buckets that threads read and
+// write without locks; a full bucket drops one of its tags. Failed
+// verifications are never stored.
+//
+
+#ifndef _VERIFY_CACHE_H
+#define _VERIFY_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define VERIFY_CACHE_WAYS 4
+#define VERIFY_CACHE_TAG_SIZE 16
+
+/* largest cache, 4 GiB of tags */
+#define VERIFY_CACHE_MAX_ENTRIES ((size_t) 1 << 28)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    size_t capacity;
+} verify_cache_stats;
+
+/* Replace the cache with an empty one of at least entries tags and a new key, 0 disables the cache.
+   Returns 0 or 1 if entries is above VERIFY_CACHE_MAX_ENTRIES, the table cannot be allocated
+   or the key cannot be drawn, the cache is disabled then */
+int verify_cache_resize(size_t entries);
+
+/* Forget every tag and reset counters */
+void verify_cache_clear(void);
+
+/* Counters of the current cache, all zero if it is disabled */
+void verify_cache_statistics(verify_cache_stats *stats);
+
+/* Compute the tag of the triple: returns 1 if it is cached, 0 if not, -1 if the cache is disabled */
+int verify_cache_lookup(unsigned char tag[VERIFY_CACHE_TAG_SIZE],
+                        const unsigned char *signature, const unsigned char *public_key,
+                        const unsigned char *message, size_t len);
+
+/* Remember a tag of verify_cache_lookup after the verification has succeeded */
+void verify_cache_insert(const unsigned char tag[VERIFY_CACHE_TAG_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+//
+// Hex codec of binary data
+//
+
+#include "ed25519.hpp"
+#include "hex.hpp"
+
+namespace ed25519 {
+
+    namespace hex {
+
+        void encode(const unsigned char *data, size_t size, char *out) {
+            hex_encode(data, size, out);
+        }
+
+        std::string encode(const unsigned char *data, size_t size) {
+            std::string str(2 * size, '\0');
+            hex_encode(data, size, str.data());
+            return str;
+        }
+
+        bool decode(std::string_view str, unsigned char *data, size_t size, const ErrorHandler &error) {
+
+            if (str.size() != 2 * size) {
+                error_category category(StringFormat("size of hex string is not equal to expected size: %zu <> %zu",
+                                                     str.size(), 2 * size));
+                std::error_code ec(static_cast<int>(error::UNEXPECTED_SIZE), category);
+                error(ec);
+                return false;
+            }
+
+            size_t decoded = hex_decode(str.data(), size, data);
+
+            if (decoded != size) {
+                error_category category(StringFormat("bad hex symbol at %zu: '%c%c'",
+                                                     2 * decoded, str[2 * decoded], str[2 * decoded + 1]));
+                std::error_code ec(static_cast<int>(error::BADFORMAT), category);
+                error(ec);
+                return false;
+            }
+
+            return true;
+        }
+    }
+}
@@ -0,0 +1,157 @@
+//
+// Bulk key pair generation and key derivation: many keys at once, on several threads
+//
+
+#include "ed25519.hpp"
+#include "ed25519_ext.hpp"
+#include "csprng.hpp"
+#include "thread_ranges.hpp"
+#include <algorithm>
+
+namespace ed25519 {
+
+    namespace keys {
+
+        namespace {
+
+            /* keys computed per thread before spawning another one is worth it */
+            constexpr size_t keys_per_thread = 256;
+
+            size_t worker_count(size_t threads, size_t count) {
+              return thread_ranges::worker_count(threads, count, keys_per_thread);
+            }
+
+            void store(Public &key, const std::array<unsigned char, size::public_key> &child) {
+              key = Public(child);
+            }
+
+            void store(PublicKeyBytes &key, const std::array<unsigned char, size::public_key> &child) {
+              std::copy(child.begin(), child.end(), key.begin());
+            }
+
+            void wipe(unsigned char *data, size_t size) {
+              volatile unsigned char *p = data;
+              for (size_t i = 0; i < size; i++) p[i] = 0;
+            }
+        }
+
+        std::vector<Pair> Pair::Generate(size_t count, size_t threads) {
+
+          std::vector<Pair> pairs(count, Pair());
+          if (count == 0) return pairs;
+
+          std::atomic<bool> failed(false);
+
+          thread_ranges::run_ranges(count, worker_count(threads, count), [&pairs, &failed](size_t first, size_t last) {
+              constexpr size_t batch = ED25519_KEYPAIRS_BATCH;
+
+              unsigned char seeds[batch * size::seed];
+              unsigned char public_keys[batch * size::public_key];
+              unsigned char private_keys[batch * size::private_key];
+
+              for (size_t from = first; from < last; from += batch) {
+                size_t n = std::min(batch, last - from);
+
+                // a zero seed would give every caller the same key
+                if (csprng_bytes(seeds, n * size::seed) != 0) {
+                  failed.store(true);
+                  break;
+                }
+
+                ed25519_create_keypairs(public_keys, private_keys, seeds, n);
+
+                for (size_t i = 0; i < n; ++i) {
+                  auto &pair = pairs[from + i];
+                  std::copy_n(public_keys + i * size::public_key, size::public_key, pair.publicKey_.data());
+                  std::copy_n(private_keys + i * size::private_key, size::private_key, pair.privateKey_.data());
+                }
+              }
+
+              wipe(seeds, sizeof(seeds));
+              wipe(private_keys, sizeof(private_keys));
+          });
+
+          if (failed.load())
+            throw std::system_error(std::make_error_code(std::errc::io_error),
+                                    "system random source is unavailable");
+
+          return pairs;
+        }
+
+        std::optional<PreparedParent> PreparedParent::Prepare(const Public &parent, const ErrorHandler &error) {
+          static_assert(sizeof(point_) == ED25519_PREPARED_KEY_SIZE, "point_ holds the cached point");
+
+          PreparedParent prepared;
+          prepared.publicKey_ = parent;
+
+          if (ed25519_prepare_public_key(prepared.point_.data(), parent.data()) != 1) {
+            error_category category("public key is not a curve point");
+            std::error_code ec(static_cast<int>(error::BADFORMAT),category);
+            error(ec);
+            return std::nullopt;
+          }
+
+          return std::make_optional(prepared);
+        }
+
+        std::optional<PreparedParent> PreparedParent::Prepare(const PublicKeyBytes &parent, const ErrorHandler &error) {
+          return Prepare(Public(parent), error);
+        }
+
+        Public PreparedParent::derive(const Tweak &tweak) const {
+          return Public(derive_bytes(tweak));
+        }
+
+        PublicKeyBytes PreparedParent::derive_bytes(const Tweak &tweak) const {
+          PublicKeyBytes child;
+          ed25519_derive_public_keys(child.data(), point_.data(), tweak.data(), 1);
+          return child;
+        }
+
+        template<typename Key>
+        std::vector<Key> PreparedParent::derive_all(const std::vector<Tweak> &tweaks, size_t threads) const {
+
+          static_assert(sizeof(Tweak) == size::tweak, "tweaks are packed");
+
+          std::vector<Key> children(tweaks.size());
+          if (tweaks.empty()) return children;
+
+          thread_ranges::run_ranges(tweaks.size(), worker_count(threads, tweaks.size()), [&](size_t first, size_t last) {
+              constexpr size_t batch = ED25519_DERIVE_BATCH;
+
+              std::array<unsigned char, batch * size::public_key> public_keys;
+              std::array<unsigned char, size::public_key> child;
+
+              for (size_t from = first; from < last; from += batch) {
+                size_t n = std::min(batch, last - from);
+
+                // tweaks are contiguous 32-byte scalars
+                ed25519_derive_public_keys(public_keys.data(), point_.data(), tweaks[from].data(), n);
+
+                for (size_t i = 0; i < n; ++i) {
+                  std::copy_n(public_keys.data() + i * size::public_key, size::public_key, child.data());
+                  store(children[from + i], child);
+                }
+              }
+          });
+
+          return children;
+        }
+
+        std::vector<Public> PreparedParent::derive(const std::vector<Tweak> &tweaks, size_t threads) const {
+          return derive_all<Public>(tweaks, threads);
+        }
+
+        std::vector<PublicKeyBytes> PreparedParent::derive_bytes(const std::vector<Tweak> &tweaks, size_t threads) const {
+          return derive_all<PublicKeyBytes>(tweaks, threads);
+        }
+
+        std::optional<PublicKeyBytes> derive(const PublicKeyBytes &parent, const Tweak &tweak) {
+          auto prepared = PreparedParent::Prepare(parent);
+          if (!prepared) {
+            return std::nullopt;
+          }
+          return prepared->derive_bytes(tweak);
+        }
+    }
+}
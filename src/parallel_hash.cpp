@@ -0,0 +1,115 @@
+//
+// ParallelHash256, NIST SP 800-185
+//
+
+#include "ed25519.hpp"
+#include "sha3.hpp"
+#include "sha3_lanes.hpp"
+#include "thread_ranges.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ed25519 {
+
+    namespace {
+
+        /* SHAKE256 chaining value size: 512 bits */
+        constexpr size_t chained_size = 64;
+        /* cSHAKE256 rate */
+        constexpr size_t rate = 136;
+        /* blocks hashed per thread before spawning another one is worth it */
+        constexpr size_t blocks_per_thread = 4 * SHA3_LANES_MAX;
+
+        size_t left_encode(uint64_t value, unsigned char *out) {
+            unsigned n = 1;
+            while (n < 8 && (value >> (8 * n)) != 0) n++;
+            out[0] = static_cast<unsigned char>(n);
+            for (unsigned i = 0; i < n; ++i)
+                out[1 + i] = static_cast<unsigned char>(value >> (8 * (n - 1 - i)));
+            return n + 1;
+        }
+
+        size_t right_encode(uint64_t value, unsigned char *out) {
+            unsigned n = 1;
+            while (n < 8 && (value >> (8 * n)) != 0) n++;
+            for (unsigned i = 0; i < n; ++i)
+                out[i] = static_cast<unsigned char>(value >> (8 * (n - 1 - i)));
+            out[n] = static_cast<unsigned char>(n);
+            return n + 1;
+        }
+
+        void hash_blocks(const unsigned char *data, size_t size, size_t block_size,
+                         size_t first, size_t last, unsigned char *chained) {
+
+            const unsigned char *messages[SHA3_LANES_MAX];
+            size_t sizes[SHA3_LANES_MAX];
+            unsigned char *out[SHA3_LANES_MAX];
+
+            for (size_t i = first; i < last; i += SHA3_LANES_MAX) {
+                size_t count = std::min<size_t>(SHA3_LANES_MAX, last - i);
+                for (size_t k = 0; k < count; ++k) {
+                    size_t offset = (i + k) * block_size;
+                    messages[k] = data + offset;
+                    sizes[k] = std::min(block_size, size - offset);
+                    out[k] = chained + (i + k) * chained_size;
+                }
+                shake256_lanes(messages, sizes, count, out, chained_size);
+            }
+        }
+    }
+
+    Digest Digest::ParallelHash(const unsigned char *data, size_t size,
+                                size_t block_size,
+                                size_t threads,
+                                std::string_view customization) {
+
+        if (block_size == 0)
+            throw std::invalid_argument("ParallelHash: block size must be positive");
+
+        size_t blocks = (size + block_size - 1) / block_size;
+        std::vector<unsigned char> chained(blocks * chained_size);
+
+        thread_ranges::run_ranges(blocks, thread_ranges::worker_count(threads, blocks, blocks_per_thread),
+                                  [&](size_t first, size_t last) {
+                                      hash_blocks(data, size, block_size, first, last, chained.data());
+                                  });
+
+        unsigned char encoded[9];
+        size_t padded = 0;
+        sha3_context ctx;
+        sha3_Init256(&ctx);
+
+        auto absorb = [&](const void *bytes, size_t length) {
+            sha3_Update(&ctx, bytes, length);
+            padded += length;
+        };
+
+        /* bytepad(encode_string(N) || encode_string(S), rate) */
+        const std::string_view function_name = "ParallelHash";
+        absorb(encoded, left_encode(rate, encoded));
+        absorb(encoded, left_encode(function_name.size() * 8, encoded));
+        absorb(function_name.data(), function_name.size());
+        absorb(encoded, left_encode(customization.size() * 8, encoded));
+        absorb(customization.data(), customization.size());
+        const unsigned char zeros[rate] = {};
+        absorb(zeros, (rate - padded % rate) % rate);
+
+        /* left_encode(B) || z_0 || ... || z_(n-1) || right_encode(n) || right_encode(L) */
+        absorb(encoded, left_encode(block_size, encoded));
+        absorb(chained.data(), chained.size());
+        absorb(encoded, right_encode(blocks, encoded));
+        absorb(encoded, right_encode(size::digest * 8, encoded));
+
+        Digest digest;
+        sha3_FinalizeXof(&ctx, 0x04, digest.data(), digest.size());
+
+        return digest;
+    }
+
+    Digest Digest::ParallelHash(const std::vector<unsigned char> &data,
+                                size_t block_size,
+                                size_t threads,
+                                std::string_view customization) {
+        return ParallelHash(data.data(), data.size(), block_size, threads, customization);
+    }
+}
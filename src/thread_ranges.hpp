@@ -0,0 +1,63 @@
+//
+// Bulk work over [0, count) split into contiguous ranges, one range per thread
+//
+
+#pragma once
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace ed25519 {
+
+    namespace thread_ranges {
+
+        /* threads worth running count items when a thread needs per_thread items to pay off,
+           0 threads is every hardware thread */
+        inline size_t worker_count(size_t threads, size_t count, size_t per_thread) {
+          if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+          return std::max<size_t>(1, std::min(threads, count / per_thread));
+        }
+
+        /* items in every range but the last one */
+        inline size_t range_size(size_t count, size_t threads) {
+          return (count + threads - 1) / threads;
+        }
+
+        /* runs job(first, last) over [0, count) split into threads ranges, job(0, ...) on the calling thread.
+           Ranges of threads that cannot be started run on the calling thread, workers are joined
+           before an exception of the calling thread leaves */
+        template<typename Job>
+        void run_ranges(size_t count, size_t threads, const Job &job) {
+          if (threads <= 1) {
+            job(0, count);
+            return;
+          }
+
+          std::vector<std::thread> workers;
+          workers.reserve(threads - 1);
+
+          struct joiner {
+              std::vector<std::thread> &workers;
+              ~joiner() {
+                for (auto &worker: workers) if (worker.joinable()) worker.join();
+              }
+          } join_workers{workers};
+
+          size_t step = range_size(count, threads);
+          size_t first = step;
+          for (; first < count; first += step) {
+            try {
+              workers.emplace_back(job, first, std::min(count, first + step));
+            }
+            catch (const std::system_error &) {
+              break;
+            }
+          }
+
+          job(0, std::min(count, step));
+          for (; first < count; first += step) job(first, std::min(count, first + step));
+        }
+    }
+}
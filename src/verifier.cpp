@@ -0,0 +1,333 @@
+//
+// Pipelined verification: hash and curve stages connected by bounded lock-free queues
+//
+
+#include "ed25519.hpp"
+#include "ed25519_ext.hpp"
+#include "verify_cache.hpp"
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+namespace ed25519 {
+
+    namespace {
+
+        /* Vyukov's bounded MPMC queue: a cell is free for the position equal to its sequence,
+           full for the position + 1; positions are claimed by CAS */
+        template<typename T>
+        class mpmc_queue {
+        public:
+            explicit mpmc_queue(size_t size): mask_(0), enqueue_(0), dequeue_(0) {
+              size_t capacity = 2;
+              while (capacity < size) capacity <<= 1;
+              mask_ = capacity - 1;
+              cells_.reset(new cell[capacity]);
+              for (size_t i = 0; i < capacity; ++i)
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            bool push(const T &value) {
+              size_t position = enqueue_.load(std::memory_order_relaxed);
+              for (;;) {
+                cell &c = cells_[position & mask_];
+                size_t sequence = c.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (diff == 0) {
+                  if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    c.value = value;
+                    c.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                  }
+                }
+                else if (diff < 0) {
+                  return false;
+                }
+                else {
+                  position = enqueue_.load(std::memory_order_relaxed);
+                }
+              }
+            }
+
+            bool pop(T &value) {
+              size_t position = dequeue_.load(std::memory_order_relaxed);
+              for (;;) {
+                cell &c = cells_[position & mask_];
+                size_t sequence = c.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+                if (diff == 0) {
+                  if (dequeue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = c.value;
+                    c.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                  }
+                }
+                else if (diff < 0) {
+                  return false;
+                }
+                else {
+                  position = dequeue_.load(std::memory_order_relaxed);
+                }
+              }
+            }
+
+            bool empty() const {
+              size_t position = dequeue_.load(std::memory_order_acquire);
+              return cells_[position & mask_].sequence.load(std::memory_order_acquire) != position + 1;
+            }
+
+            bool full() const {
+              size_t position = enqueue_.load(std::memory_order_acquire);
+              return cells_[position & mask_].sequence.load(std::memory_order_acquire) != position;
+            }
+
+        private:
+            struct cell {
+                std::atomic<size_t> sequence;
+                T value;
+            };
+
+            std::unique_ptr<cell[]> cells_;
+            size_t mask_;
+            alignas(64) std::atomic<size_t> enqueue_;
+            alignas(64) std::atomic<size_t> dequeue_;
+        };
+
+        /* sleeping side of a queue: a waiter registers before it checks the queue again,
+           a notifier fences after its push before it looks for waiters */
+        class signal {
+        public:
+            signal(): waiters_(0) {}
+
+            template<typename Ready>
+            void wait(const Ready &ready) {
+              std::unique_lock<std::mutex> lock(mutex_);
+              waiters_.fetch_add(1);
+              condition_.wait_for(lock, std::chrono::milliseconds(100), ready);
+              waiters_.fetch_sub(1);
+            }
+
+            void notify() {
+              std::atomic_thread_fence(std::memory_order_seq_cst);
+              if (waiters_.load() > 0) wake();
+            }
+
+            void wake() {
+              std::lock_guard<std::mutex> lock(mutex_);
+              condition_.notify_all();
+            }
+
+        private:
+            std::mutex mutex_;
+            std::condition_variable condition_;
+            std::atomic<size_t> waiters_;
+        };
+
+        /* pipeline the calling thread works for, completions run there */
+        thread_local const void *worker_of = nullptr;
+
+        struct request {
+            unsigned char signature[size::signature];
+            unsigned char key[size::public_key];
+            unsigned char h[size::hash];
+            unsigned char tag[VERIFY_CACHE_TAG_SIZE];
+            int cached;
+            std::vector<unsigned char> message;
+            Verifier::Completion completion;
+        };
+    }
+
+    struct Verifier::pipeline {
+
+        mpmc_queue<request *> input;
+        mpmc_queue<request *> curve;
+
+        signal input_ready, input_space;
+        signal curve_ready, curve_space;
+
+        std::atomic<bool> stopping;
+
+        std::atomic<size_t> in_flight;
+        std::mutex done_mutex;
+        std::condition_variable done;
+
+        std::vector<std::thread> workers;
+
+        explicit pipeline(size_t queue_size): input(queue_size), curve(queue_size), stopping(false), in_flight(0) {}
+
+        void complete(request *r, bool verified) {
+          r->completion(verified);
+          delete r;
+          if (in_flight.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(done_mutex);
+            done.notify_all();
+          }
+        }
+
+        void hash_stage() {
+          worker_of = this;
+          for (;;) {
+            request *r;
+            if (!input.pop(r)) {
+              if (stopping.load()) return;
+              input_ready.wait([this] { return stopping.load() || !input.empty(); });
+              continue;
+            }
+            input_space.notify();
+
+            r->cached = verify_cache_lookup(r->tag, r->signature, r->key, r->message.data(), r->message.size());
+            if (r->cached == 1) {
+              complete(r, true);
+              continue;
+            }
+
+            ed25519_verify_hash(r->h, r->signature, r->key, r->message.data(), r->message.size());
+            std::vector<unsigned char>().swap(r->message);
+
+            while (!curve.push(r))
+              curve_space.wait([this] { return !curve.full(); });
+            curve_ready.notify();
+          }
+        }
+
+        void curve_stage() {
+          worker_of = this;
+          for (;;) {
+            request *r;
+            if (!curve.pop(r)) {
+              if (stopping.load()) return;
+              curve_ready.wait([this] { return stopping.load() || !curve.empty(); });
+              continue;
+            }
+            curve_space.notify();
+
+            bool verified = ed25519_verify_hashed(r->signature, r->key, r->h) == 1;
+            if (verified && r->cached == 0)
+              verify_cache_insert(r->tag);
+            complete(r, verified);
+          }
+        }
+
+        request *make(const unsigned char *signature, const unsigned char *key, std::vector<unsigned char> &&message,
+                      Completion &&completion) {
+          auto r = new request();
+          std::memcpy(r->signature, signature, size::signature);
+          std::memcpy(r->key, key, size::public_key);
+          r->message = std::move(message);
+          r->completion = std::move(completion);
+          return r;
+        }
+
+        void submit(request *r) {
+          in_flight.fetch_add(1);
+          while (!input.push(r))
+            input_space.wait([this] { return !input.full(); });
+          input_ready.notify();
+        }
+
+        bool try_submit(request *r) {
+          in_flight.fetch_add(1);
+          if (!input.push(r)) {
+            in_flight.fetch_sub(1);
+            delete r;
+            return false;
+          }
+          input_ready.notify();
+          return true;
+        }
+    };
+
+    Verifier::Verifier(size_t hash_threads, size_t curve_threads, size_t queue_size):
+            pipeline_(new pipeline(queue_size)) {
+
+      if (curve_threads == 0) curve_threads = std::max(1u, std::thread::hardware_concurrency());
+      hash_threads = std::max<size_t>(1, hash_threads);
+
+      for (size_t i = 0; i < hash_threads; ++i)
+        pipeline_->workers.emplace_back([this] { pipeline_->hash_stage(); });
+      for (size_t i = 0; i < curve_threads; ++i)
+        pipeline_->workers.emplace_back([this] { pipeline_->curve_stage(); });
+    }
+
+    Verifier::~Verifier() {
+      wait();
+
+      pipeline_->stopping.store(true);
+      pipeline_->input_ready.wake();
+      pipeline_->curve_ready.wake();
+
+      for (auto &worker: pipeline_->workers) worker.join();
+    }
+
+    void Verifier::submit(const Signature &signature, const keys::Public &key, std::vector<unsigned char> message,
+                          Completion completion) {
+
+      pipeline_->submit(pipeline_->make(signature.data(), key.data(), std::move(message), std::move(completion)));
+    }
+
+    void Verifier::submit(const Signature &signature, const keys::Public &key, std::string_view message,
+                          Completion completion) {
+      submit(signature, key, std::vector<unsigned char>(message.begin(), message.end()), std::move(completion));
+    }
+
+    void Verifier::submit(const SignatureBytes &signature, const PublicKeyBytes &key, std::vector<unsigned char> message,
+                          Completion completion) {
+      pipeline_->submit(pipeline_->make(signature.data(), key.data(), std::move(message), std::move(completion)));
+    }
+
+    void Verifier::submit(const SignatureBytes &signature, const PublicKeyBytes &key, std::string_view message,
+                          Completion completion) {
+      submit(signature, key, std::vector<unsigned char>(message.begin(), message.end()), std::move(completion));
+    }
+
+    bool Verifier::try_submit(const Signature &signature, const keys::Public &key, std::vector<unsigned char> message,
+                              Completion completion) {
+
+      if (pipeline_->input.full())
+        return false;
+
+      return pipeline_->try_submit(
+              pipeline_->make(signature.data(), key.data(), std::move(message), std::move(completion)));
+    }
+
+    bool Verifier::try_submit(const Signature &signature, const keys::Public &key, std::string_view message,
+                              Completion completion) {
+
+      // the message is not copied for a request the queue has no room for
+      if (pipeline_->input.full())
+        return false;
+
+      return try_submit(signature, key, std::vector<unsigned char>(message.begin(), message.end()),
+                        std::move(completion));
+    }
+
+    bool Verifier::try_submit(const SignatureBytes &signature, const PublicKeyBytes &key,
+                              std::vector<unsigned char> message, Completion completion) {
+
+      if (pipeline_->input.full())
+        return false;
+
+      return pipeline_->try_submit(
+              pipeline_->make(signature.data(), key.data(), std::move(message), std::move(completion)));
+    }
+
+    bool Verifier::try_submit(const SignatureBytes &signature, const PublicKeyBytes &key, std::string_view message,
+                              Completion completion) {
+
+      if (pipeline_->input.full())
+        return false;
+
+      return try_submit(signature, key, std::vector<unsigned char>(message.begin(), message.end()),
+                        std::move(completion));
+    }
+
+    void Verifier::wait() {
+      // the request of the calling completion is in flight until it returns
+      assert(worker_of != pipeline_.get() && "Verifier::wait() or destruction from a completion");
+
+      std::unique_lock<std::mutex> lock(pipeline_->done_mutex);
+      pipeline_->done.wait(lock, [this] { return pipeline_->in_flight.load() == 0; });
+    }
+}
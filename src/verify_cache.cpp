@@ -0,0 +1,34 @@
+//
+// Cache of successful signature verifications
+//
+
+#include "ed25519.hpp"
+#include "verify_cache.hpp"
+
+namespace ed25519 {
+
+    namespace verify_cache {
+
+        bool enable(size_t entries) {
+          return verify_cache_resize(std::max<size_t>(1, entries)) == 0;
+        }
+
+        void disable() {
+          verify_cache_resize(0);
+        }
+
+        bool enabled() {
+          return stats().capacity > 0;
+        }
+
+        void clear() {
+          verify_cache_clear();
+        }
+
+        statistics stats() {
+          verify_cache_stats counters;
+          verify_cache_statistics(&counters);
+          return statistics{counters.hits, counters.misses, counters.insertions, counters.capacity};
+        }
+    }
+}
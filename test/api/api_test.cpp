@@ -4,6 +4,15 @@
 
 #include "ed25519.hpp"
 #include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <thread>
+#include <memory_resource>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 #include "gtest/gtest.h"
 
 #define ALL_TESTS 1
@@ -184,4 +193,957 @@ TEST(TEST_API, signature ) {
   }
 }
 
-#endif
\ No newline at end of file
+template<size_t N>
+static std::string generic_encode(const std::array<unsigned char, N> &data) {
+  std::vector<unsigned char> v(data.begin(), data.end());
+  auto crc = ed25519::base58::crc32(v.data(), v.size());
+  for (int i = 0; i < 4; ++i) v.push_back(static_cast<unsigned char>((crc >> (8 * i)) & 0xff));
+  return ed25519::base58::encode(v);
+}
+
+template<size_t N>
+static void check_fixed_codec(const std::array<unsigned char, N> &data) {
+  auto fixed = ed25519::base58::encode_fixed(data);
+  auto expected = generic_encode(data);
+  EXPECT_EQ(fixed.str(), expected);
+  EXPECT_EQ(std::string(fixed.c_str()), expected);
+
+  std::array<unsigned char, N> decoded{};
+  EXPECT_TRUE(ed25519::base58::decode_fixed(expected, decoded));
+  EXPECT_TRUE(decoded == data);
+  EXPECT_TRUE(ed25519::base58::decode_fixed("  " + expected + "\n", decoded));
+  EXPECT_TRUE(decoded == data);
+}
+
+TEST(TEST_API, base58_fixed ) {
+
+  std::array<unsigned char, ed25519::size::hash> hash{};
+  std::array<unsigned char, ed25519::size::double_hash> double_hash{};
+
+  // zeroes, leading zeroes and all-ones
+  check_fixed_codec(hash);
+  check_fixed_codec(double_hash);
+  hash.fill(0xff);
+  double_hash.fill(0xff);
+  check_fixed_codec(hash);
+  check_fixed_codec(double_hash);
+  for (size_t i = 0; i < hash.size(); ++i) hash[i] = i < 5 ? 0 : static_cast<unsigned char>(i);
+  for (size_t i = 0; i < double_hash.size(); ++i) double_hash[i] = i < 9 ? 0 : static_cast<unsigned char>(i * 7);
+  check_fixed_codec(hash);
+  check_fixed_codec(double_hash);
+
+  for (int k = 0; k < 1000; ++k) {
+    ed25519::Seed seed;
+    check_fixed_codec<ed25519::size::hash>(seed);
+    auto pair = ed25519::keys::Pair::Random();
+    EXPECT_EQ(pair->get_public_key().encode_fixed(), pair->get_public_key().encode());
+    EXPECT_EQ(pair->get_private_key().encode_fixed(), pair->get_private_key().encode());
+    check_fixed_codec<ed25519::size::double_hash>(pair->get_private_key());
+  }
+
+  // errors are the same as the generic decoder
+  auto encoded = generic_encode(hash);
+  std::array<unsigned char, ed25519::size::hash> decoded{};
+  auto wrong = encoded;
+  wrong[wrong.size() / 2] = wrong[wrong.size() / 2] == 'z' ? 'y' : 'z';
+  EXPECT_FALSE(ed25519::base58::decode_fixed(wrong, decoded));
+  EXPECT_FALSE(ed25519::base58::decode_fixed(encoded + "0", decoded));
+  EXPECT_FALSE(ed25519::base58::decode_fixed(encoded + " x", decoded));
+  EXPECT_FALSE(ed25519::base58::decode_fixed("1" + encoded, decoded));
+  EXPECT_FALSE(ed25519::base58::decode_fixed(std::string(200, 'z'), decoded));
+  EXPECT_FALSE(ed25519::base58::decode_fixed("", decoded));
+
+  std::error_code code;
+  auto last_error = [&code](const std::error_code &ec) { code = ec; };
+
+  EXPECT_FALSE(ed25519::base58::decode(wrong, decoded, last_error));
+  EXPECT_EQ(code.value(), ed25519::error::BADFORMAT);
+  EXPECT_FALSE(ed25519::base58::decode(generic_encode(double_hash), decoded, last_error));
+  EXPECT_EQ(code.value(), ed25519::error::UNEXPECTED_SIZE);
+  EXPECT_TRUE(ed25519::base58::decode(encoded, decoded, last_error));
+  EXPECT_TRUE(decoded == hash);
+}
+
+TEST(TEST_API, validate_fixed ) {
+  auto pair = ed25519::keys::Pair::WithSecret("some secret phrase");
+  auto public_key = pair->get_public_key().encode();
+  auto private_key = pair->get_private_key().encode();
+
+  EXPECT_TRUE(ed25519::base58::validate<ed25519::size::public_key>(public_key));
+  EXPECT_TRUE(ed25519::base58::validate<ed25519::size::private_key>(private_key));
+  EXPECT_FALSE(ed25519::base58::validate<ed25519::size::private_key>(public_key));
+  EXPECT_FALSE(ed25519::base58::validate<ed25519::size::public_key>(private_key));
+  EXPECT_TRUE(ed25519::base58::validate<ed25519::size::public_key>(" " + public_key + "\t"));
+
+  EXPECT_TRUE(ed25519::keys::Public::validate(public_key));
+  EXPECT_FALSE(ed25519::keys::Public::validate(private_key));
+  EXPECT_TRUE(ed25519::keys::Private::validate(private_key));
+
+  // the size-agnostic validation accepts both
+  EXPECT_TRUE(ed25519::base58::validate(public_key));
+  EXPECT_TRUE(ed25519::base58::validate(private_key));
+
+  for (auto broken: {public_key + "0", public_key + "I", "O" + public_key, public_key.substr(1),
+                     std::string("\xff") + public_key, std::string()}) {
+    EXPECT_FALSE(ed25519::base58::validate<ed25519::size::public_key>(broken)) << broken;
+    EXPECT_FALSE(ed25519::base58::validate(broken)) << broken;
+  }
+
+  // long strings are validated on the heap
+  std::vector<unsigned char> payload(300, 0x5a);
+  auto crc = ed25519::base58::crc32(payload.data(), payload.size());
+  for (int i = 0; i < 4; ++i) payload.push_back(static_cast<unsigned char>((crc >> (8 * i)) & 0xff));
+  auto encoded = ed25519::base58::encode(payload);
+  EXPECT_TRUE(encoded.size() > 256);
+  EXPECT_TRUE(ed25519::base58::validate(encoded));
+  encoded[100] = encoded[100] == 'z' ? 'y' : 'z';
+  EXPECT_FALSE(ed25519::base58::validate(encoded));
+}
+
+TEST(TEST_API, crc32 ) {
+  std::string check = "123456789";
+  EXPECT_EQ(ed25519::base58::crc32(reinterpret_cast<const unsigned char *>(check.data()), check.size()), 0xCBF43926u);
+
+  // zlib crc32 of i % 251, short inputs take the tables, long ones the folding path
+  std::vector<unsigned char> data(100000);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<unsigned char>(i % 251);
+  EXPECT_EQ(ed25519::base58::crc32(data.data(), 0), 0u);
+  EXPECT_EQ(ed25519::base58::crc32(data.data(), 36), 0x25715854u);
+  EXPECT_EQ(ed25519::base58::crc32(data.data(), 68), 0x5918d258u);
+  EXPECT_EQ(ed25519::base58::crc32(data.data(), 1000), 0x721746a6u);
+  EXPECT_EQ(ed25519::base58::crc32(data.data(), data.size()), 0xb353b8fau);
+}
+
+TEST(TEST_API, base58_bulk ) {
+  std::vector<ed25519::keys::Public> keys;
+  std::vector<ed25519::keys::Private> secrets;
+  for (int k = 0; k < 3000; ++k) {
+    auto pair = ed25519::keys::Pair::Random();
+    keys.push_back(pair->get_public_key());
+    secrets.push_back(pair->get_private_key());
+  }
+
+  for (size_t threads: {1, 3, 0}) {
+    auto list = ed25519::base58::encode_bulk(keys, threads);
+    EXPECT_EQ(list.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+      EXPECT_EQ(list[i], keys[i].encode());
+
+    std::vector<std::array<unsigned char, ed25519::size::public_key>> decoded;
+    EXPECT_TRUE(ed25519::base58::decode_bulk(list.buffer, decoded, threads));
+    EXPECT_EQ(decoded.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+      EXPECT_TRUE(std::equal(decoded[i].begin(), decoded[i].end(), std::as_const(keys[i]).data()));
+  }
+
+  auto list = ed25519::base58::encode_bulk(secrets);
+  EXPECT_EQ(list[7], secrets[7].encode());
+  EXPECT_EQ(ed25519::base58::encode_bulk(std::vector<ed25519::keys::Public>()).size(), 0u);
+
+  // other sizes take the generic codec
+  std::vector<std::array<unsigned char, 20>> records(50);
+  for (size_t i = 0; i < records.size(); ++i) records[i].fill(static_cast<unsigned char>(i));
+  auto encoded = ed25519::base58::encode_bulk(records);
+  EXPECT_EQ(encoded[3], ed25519::base58::encode(records[3]));
+  std::vector<std::array<unsigned char, 20>> records_decoded;
+  EXPECT_TRUE(ed25519::base58::decode_bulk(encoded.buffer, records_decoded));
+  EXPECT_TRUE(records_decoded == records);
+
+  // a missing final newline and CRLF line ends are accepted
+  std::vector<std::array<unsigned char, ed25519::size::public_key>> decoded;
+  auto text = keys[0].encode() + "\r\n" + keys[1].encode();
+  EXPECT_EQ(ed25519::base58::count_lines(text), 2u);
+  EXPECT_TRUE(ed25519::base58::decode_bulk(text, decoded));
+  EXPECT_EQ(decoded.size(), 2u);
+
+  // the first broken line is reported
+  std::error_code code;
+  std::string message;
+  auto last_error = [&](const std::error_code &ec) { code = ec; message = ec.message(); };
+
+  text = list.buffer;
+  EXPECT_FALSE(ed25519::base58::decode_bulk(text, decoded, 3, last_error));
+  EXPECT_EQ(code.value(), ed25519::error::UNEXPECTED_SIZE);
+  EXPECT_EQ(message.rfind("line 1: ", 0), 0u);
+  EXPECT_TRUE(decoded.empty());
+
+  auto keys_list = ed25519::base58::encode_bulk(keys);
+  text = keys_list.buffer;
+  text[keys_list.offsets[2000] + 10] = '0';
+  text[keys_list.offsets[2500] + 10] = '0';
+  EXPECT_FALSE(ed25519::base58::decode_bulk(text, decoded, 3, last_error));
+  EXPECT_EQ(code.value(), ed25519::error::BADFORMAT);
+  EXPECT_EQ(message.rfind("line 2001: ", 0), 0u);
+
+  // a count that does not match the text is reported, not read past the end
+  std::vector<unsigned char> raw(3 * ed25519::size::public_key);
+  text = keys[0].encode() + "\n" + keys[1].encode() + "\n";
+  EXPECT_FALSE(ed25519::base58::decode_bulk(text, ed25519::size::public_key, raw.data(), 3, 0, last_error));
+  EXPECT_EQ(code.value(), ed25519::error::UNEXPECTED_SIZE);
+  EXPECT_EQ(message, "number of lines is not equal to expected count: 2 <> 3");
+  EXPECT_TRUE(ed25519::base58::decode_bulk(text, ed25519::size::public_key, raw.data(), 2, 0, last_error));
+
+  // streaming through a file
+  auto file = std::tmpfile();
+  EXPECT_TRUE(ed25519::base58::write_bulk(fileno(file), keys));
+  std::rewind(file);
+  decoded.clear();
+  EXPECT_TRUE(ed25519::base58::read_bulk(fileno(file), decoded));
+  EXPECT_EQ(decoded.size(), keys.size());
+  EXPECT_TRUE(std::equal(decoded.back().begin(), decoded.back().end(), std::as_const(keys).back().data()));
+  std::fclose(file);
+}
+
+TEST(TEST_API, hex ) {
+  // every length takes the SIMD blocks and the table tail
+  for (size_t size = 0; size < 200; ++size) {
+    std::vector<unsigned char> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = static_cast<unsigned char>(i * 37 + size);
+    std::string expected;
+    for (auto c: data) expected += ed25519::StringFormat("%02x", c);
+
+    EXPECT_EQ(ed25519::hex::encode(data.data(), data.size()), expected);
+
+    std::vector<unsigned char> decoded(size);
+    EXPECT_TRUE(ed25519::hex::decode(expected, decoded.data(), decoded.size()));
+    EXPECT_TRUE(decoded == data);
+
+    for (auto &c: expected) c = static_cast<char>(toupper(c));
+    EXPECT_TRUE(ed25519::hex::decode(expected, decoded.data(), decoded.size()));
+    EXPECT_TRUE(decoded == data);
+  }
+
+  auto pair = ed25519::keys::Pair::WithSecret("some secret phrase");
+  auto digest = ed25519::Digest([](auto &calculator) { calculator.append(std::string_view("abc")); });
+  auto signature = pair->sign(digest);
+
+  auto hex = signature->to_hex();
+  EXPECT_EQ(hex.size(), 2 * ed25519::size::signature);
+  auto restored = ed25519::Signature::FromHex(hex);
+  EXPECT_TRUE(restored);
+  EXPECT_EQ(restored->encode(), signature->encode());
+  EXPECT_TRUE(restored->verify(digest, pair->get_public_key()));
+
+  EXPECT_EQ(ed25519::keys::Public::FromHex(pair->get_public_key().to_hex())->encode(), pair->get_public_key().encode());
+  EXPECT_EQ(ed25519::Digest::FromHex(digest.to_hex())->encode(), digest.encode());
+
+  std::error_code code;
+  std::string message;
+  auto last_error = [&](const std::error_code &ec) { code = ec; message = ec.message(); };
+
+  EXPECT_FALSE(ed25519::Digest::FromHex(hex, last_error));
+  EXPECT_EQ(code.value(), ed25519::error::UNEXPECTED_SIZE);
+  EXPECT_FALSE(ed25519::Signature::FromHex(hex.substr(1), last_error));
+  EXPECT_EQ(code.value(), ed25519::error::UNEXPECTED_SIZE);
+
+  for (size_t at: {0, 31, 64, 127}) {
+    auto broken = hex;
+    broken[at] = 'g';
+    EXPECT_FALSE(ed25519::Signature::FromHex(broken, last_error));
+    EXPECT_EQ(code.value(), ed25519::error::BADFORMAT);
+    EXPECT_EQ(message.rfind(ed25519::StringFormat("bad hex symbol at %zu", at / 2 * 2), 0), 0u) << message;
+  }
+
+  // data is not changed when decoding is failed
+  auto copy = digest;
+  EXPECT_FALSE(copy.from_hex(std::string(64, 'z')));
+  EXPECT_TRUE(copy == digest);
+}
+
+TEST(TEST_API, encoded_memo ) {
+  auto pair = ed25519::keys::Pair::Random();
+  auto digest = ed25519::Digest([](auto &calculator) { calculator.append(std::string_view("abc")); });
+  auto signature = pair->sign(digest);
+
+  ed25519::keys::EncodedPublic key(pair->get_public_key());
+  ed25519::EncodedSignature encoded_signature(*signature);
+  ed25519::EncodedDigest encoded_digest(digest);
+
+  EXPECT_EQ(key.encode(), pair->get_public_key().encode());
+  EXPECT_EQ(key.encode().data(), key.encode().data());
+  EXPECT_EQ(encoded_signature.encode(), signature->encode());
+  EXPECT_EQ(encoded_digest.encode(), digest.encode());
+  EXPECT_TRUE(encoded_signature.get().verify(digest, key));
+
+  // copies keep the cached string
+  auto copy = key;
+  EXPECT_EQ(copy.encode(), key.encode());
+  EXPECT_TRUE(copy == key);
+
+  // decode and clean drop the cached string
+  auto other = ed25519::keys::Pair::Random()->get_public_key();
+  EXPECT_TRUE(copy.decode(other.encode()));
+  EXPECT_EQ(copy.encode(), other.encode());
+  EXPECT_TRUE(copy != key);
+  EXPECT_FALSE(copy.decode("broken"));
+  EXPECT_EQ(copy.encode(), other.encode());
+
+  copy.clean();
+  EXPECT_EQ(copy.encode(), ed25519::keys::Public().encode());
+
+  // concurrent readers see the same string
+  ed25519::EncodedDigest shared(digest);
+  std::vector<std::thread> readers;
+  std::atomic<int> matches(0);
+  for (int t = 0; t < 8; ++t) {
+    readers.emplace_back([&] {
+        for (int k = 0; k < 1000; ++k) matches += shared.encode() == digest.encode();
+    });
+  }
+  for (auto &reader: readers) reader.join();
+  EXPECT_EQ(matches.load(), 8000);
+}
+
+TEST(TEST_API, pubkey_literal ) {
+  using namespace ed25519::literals;
+
+  // decoded by the compiler, a broken literal does not compile
+  constexpr auto root = "YFFyxC9JuQ7x9JyL95UpqEqyRf26K8W6UWs6fnoyaMNEeRpRr"_pubkey;
+  static_assert(root.size() == ed25519::size::public_key, "public key size");
+
+  auto pair = ed25519::keys::Pair::WithSecret("some secret phrase");
+  ed25519::keys::Public key(root);
+  EXPECT_EQ(key.encode(), pair->get_public_key().encode());
+  EXPECT_EQ(key.encode(), "YFFyxC9JuQ7x9JyL95UpqEqyRf26K8W6UWs6fnoyaMNEeRpRr");
+
+  constexpr auto digest = ed25519::base58::decode_constexpr<ed25519::size::digest>(
+          "SojeERR4fWh6UcxGAZchoU2CSHmeftQxEqr6MNtyEtWfXDDVU");
+  auto abc = ed25519::Digest([](auto &calculator) { calculator.append(std::string_view("abc")); });
+  EXPECT_TRUE(std::equal(digest.begin(), digest.end(), abc.begin()));
+
+  // the same results as the runtime decoder
+  for (int k = 0; k < 100; ++k) {
+    auto random = ed25519::keys::Pair::Random();
+    auto encoded = random->get_private_key().encode();
+    auto bytes = ed25519::base58::decode_constexpr<ed25519::size::private_key>(" " + encoded + "\n");
+    EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), random->get_private_key().data()));
+  }
+
+  std::array<unsigned char, ed25519::size::hash> zeroes{};
+  EXPECT_TRUE(ed25519::base58::decode_constexpr<ed25519::size::hash>(ed25519::base58::encode(zeroes)) == zeroes);
+
+  // evaluated at run time errors throw
+  auto encoded = pair->get_public_key().encode();
+  auto wrong = encoded;
+  wrong[10] = wrong[10] == 'z' ? 'y' : 'z';
+  for (auto broken: {wrong, encoded + "0", "1" + encoded, encoded.substr(1), std::string()}) {
+    EXPECT_THROW(ed25519::base58::decode_constexpr<ed25519::size::public_key>(broken), std::invalid_argument) << broken;
+  }
+  EXPECT_THROW(ed25519::base58::decode_constexpr<ed25519::size::public_key>(pair->get_private_key().encode()),
+               std::invalid_argument);
+}
+
+TEST(TEST_API, try_decode ) {
+  auto pair = ed25519::keys::Pair::WithSecret("some secret phrase");
+  auto public_key = pair->get_public_key().encode();
+  auto private_key = pair->get_private_key().encode();
+  auto digest = ed25519::Digest([](auto &calculator) { calculator.append(std::string_view("abc")); });
+  auto signature = pair->sign(digest);
+
+  auto key = ed25519::keys::Public::TryDecode(public_key);
+  EXPECT_TRUE(key);
+  EXPECT_EQ(key->encode(), public_key);
+  EXPECT_EQ(ed25519::keys::Private::TryDecode(private_key).value().encode(), private_key);
+  EXPECT_EQ(ed25519::Digest::TryDecode(digest.encode())->encode(), digest.encode());
+  auto restored = ed25519::Signature::TryDecode(signature->encode());
+  EXPECT_TRUE(restored && restored->verify(digest, *key));
+
+  // the same errors as the handler-based decoding
+  std::error_code code;
+  std::string message;
+  auto last_error = [&](const std::error_code &ec) { code = ec; message = ec.message(); };
+
+  auto wrong = public_key;
+  wrong[10] = wrong[10] == 'z' ? 'y' : 'z';
+  std::vector<unsigned char> payload(300, 0x5a);
+  auto crc = ed25519::base58::crc32(payload.data(), payload.size());
+  for (int i = 0; i < 4; ++i) payload.push_back(static_cast<unsigned char>((crc >> (8 * i)) & 0xff));
+
+  for (auto broken: {wrong, public_key + "0", private_key, std::string(), std::string("  "),
+                     ed25519::base58::encode(std::vector<unsigned char>{1, 2}),
+                     ed25519::base58::encode(payload)}) {
+    auto failed = ed25519::keys::Public::TryDecode(broken);
+    EXPECT_FALSE(failed) << broken;
+    EXPECT_FALSE(ed25519::keys::Public::Decode(broken, last_error));
+    EXPECT_EQ(failed.error().code, code.value()) << broken;
+    EXPECT_EQ(failed.error().expected_size, ed25519::size::public_key);
+    if (broken.size() < 256) {
+      EXPECT_EQ(failed.message(), message);
+    }
+  }
+
+  auto failed = ed25519::keys::Public::TryDecode(private_key);
+  EXPECT_EQ(failed.error().code, ed25519::error::UNEXPECTED_SIZE);
+  EXPECT_EQ(failed.error().size, ed25519::size::private_key);
+
+  failed = ed25519::keys::Public::TryDecode(ed25519::base58::encode(payload));
+  EXPECT_EQ(failed.error().size, SIZE_MAX);
+  EXPECT_EQ(failed.message(), "size of decoded vector is not equal to expected size: more than 256 <> 32");
+
+  // other sizes take the generic decoder
+  ed25519::Data<20> record;
+  record.fill(7);
+  EXPECT_TRUE(ed25519::Data<20>::TryDecode(record.encode()).value() == record);
+  EXPECT_EQ(ed25519::Data<20>::TryDecode(public_key).error().size, ed25519::size::public_key);
+
+  // an embedded '\0' is a bad character, whatever the length of the string
+  auto long_string = ed25519::base58::encode(payload);
+  ASSERT_GE(long_string.size(), 256u);
+  EXPECT_TRUE(ed25519::base58::validate(long_string));
+  for (auto &valid: {public_key, record.encode(), long_string}) {
+    auto with_nul = valid + std::string(1, '\0') + "1";
+    std::vector<unsigned char> bytes;
+    EXPECT_FALSE(ed25519::base58::validate(with_nul));
+    EXPECT_FALSE(ed25519::base58::decode(with_nul, bytes));
+  }
+  auto key_nul = public_key + std::string(1, '\0');
+  EXPECT_FALSE(ed25519::keys::Public::TryDecode(key_nul));
+  EXPECT_FALSE(ed25519::keys::Public::Decode(key_nul));
+  EXPECT_FALSE(ed25519::keys::Public::validate(key_nul));
+  EXPECT_FALSE(ed25519::Data<20>::TryDecode(record.encode() + std::string(1, '\0')));
+}
+
+TEST(TEST_API, validate_binary ) {
+  auto pair = ed25519::keys::Pair::WithSecret("some secret phrase");
+  auto digest = ed25519::Digest([](auto &calculator) { calculator.append(std::string_view("abc")); });
+
+  EXPECT_TRUE(pair->validate());
+  EXPECT_TRUE(digest.validate());
+
+  for (int k = 0; k < 100; ++k) {
+    auto random = ed25519::keys::Pair::Random();
+    EXPECT_TRUE(random->validate());
+    EXPECT_TRUE(random->get_public_key().validate());
+    EXPECT_TRUE(random->get_private_key().validate());
+    EXPECT_TRUE(random->sign(digest)->validate());
+  }
+
+  // signature S must be less than the group order L
+  auto signature = pair->sign(digest);
+  auto bytes = ed25519::Data<ed25519::size::signature>::TryDecode(signature->encode()).value();
+  const unsigned char order[32] = {
+          0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+          0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10};
+  std::copy_n(order, 32, bytes.begin() + 32);
+  EXPECT_FALSE(ed25519::Signature::TryDecode(bytes.encode())->validate());
+  bytes[32] -= 1;
+  EXPECT_TRUE(ed25519::Signature::TryDecode(bytes.encode())->validate());
+  bytes[63] |= 0xe0;
+  EXPECT_FALSE(ed25519::Signature::TryDecode(bytes.encode())->validate());
+
+  // public keys: y < p and on the curve
+  std::array<unsigned char, ed25519::size::public_key> point{};
+  point.fill(0xff);
+  point[0] = 0xed;
+  point[31] = 0x7f;
+  EXPECT_FALSE(ed25519::keys::Public(point).validate());
+  // y = p - 1 is the point of order 2
+  point[0] = 0xec;
+  EXPECT_TRUE(ed25519::keys::Public(point).validate());
+  int off_curve = 0;
+  for (unsigned char y = 2; y < 40; ++y) {
+    point.fill(0);
+    point[0] = y;
+    off_curve += !ed25519::keys::Public(point).validate();
+  }
+  EXPECT_TRUE(off_curve > 0);
+
+  // private scalars are clamped or reduced
+  auto scalar = ed25519::Data<ed25519::size::private_key>::TryDecode(pair->get_private_key().encode()).value();
+  scalar[31] |= 0x80;
+  EXPECT_FALSE(ed25519::keys::Private::TryDecode(scalar.encode())->validate());
+  scalar[31] = 0x0f;
+  EXPECT_TRUE(ed25519::keys::Private::TryDecode(scalar.encode())->validate());
+}
+
+TEST(TEST_API, seed_random ) {
+  // seeds of many threads and many refills are distinct
+  std::vector<std::vector<std::string>> seeds(4);
+  std::vector<std::thread> threads;
+  for (auto &list: seeds) {
+    threads.emplace_back([&list] {
+        for (int k = 0; k < 5000; ++k) list.push_back(ed25519::Seed().encode());
+    });
+  }
+  for (auto &thread: threads) thread.join();
+
+  std::vector<std::string> all;
+  for (auto &list: seeds) all.insert(all.end(), list.begin(), list.end());
+  std::sort(all.begin(), all.end());
+  EXPECT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end());
+
+  // bits are balanced
+  size_t ones = 0;
+  for (int k = 0; k < 1000; ++k) {
+    ed25519::Seed seed;
+    for (auto c: seed) ones += static_cast<size_t>(__builtin_popcount(c));
+  }
+  EXPECT_NEAR(static_cast<double>(ones) / (1000 * 256), 0.5, 0.01);
+
+#ifndef _WIN32
+  // a child process does not repeat the parent's output
+  ed25519::Seed before;
+  int channel[2];
+  ASSERT_EQ(pipe(channel), 0);
+  auto child = fork();
+  ASSERT_TRUE(child >= 0);
+  if (child == 0) {
+    ed25519::Seed seed;
+    auto written = write(channel[1], seed.data(), seed.size());
+    _exit(written == static_cast<ssize_t>(seed.size()) ? 0 : 1);
+  }
+  ed25519::Seed parent;
+  std::array<unsigned char, ed25519::size::seed> from_child{};
+  EXPECT_EQ(read(channel[0], from_child.data(), from_child.size()), static_cast<ssize_t>(from_child.size()));
+  int status = 0;
+  waitpid(child, &status, 0);
+  close(channel[0]);
+  close(channel[1]);
+  EXPECT_FALSE(std::equal(from_child.begin(), from_child.end(), parent.begin()));
+  EXPECT_FALSE(std::equal(from_child.begin(), from_child.end(), before.begin()));
+#endif
+}
+
+TEST(TEST_API, pair_generate) {
+
+  EXPECT_TRUE(ed25519::keys::Pair::Generate(0).empty());
+
+  // odd count: partial batches on every thread
+  auto pairs = ed25519::keys::Pair::Generate(1000 + 3, 3);
+  ASSERT_EQ(pairs.size(), 1003u);
+
+  std::vector<std::string> publics;
+  for (auto &pair: pairs) {
+    EXPECT_TRUE(pair.validate());
+
+    // the shared inversion gives the same public key as the single pair path
+    auto restored = ed25519::keys::Pair::FromPrivateKey(pair.get_private_key().encode());
+    ASSERT_TRUE(restored);
+    EXPECT_EQ(restored->get_public_key(), pair.get_public_key());
+
+    publics.push_back(pair.get_public_key().encode());
+  }
+
+  std::sort(publics.begin(), publics.end());
+  EXPECT_TRUE(std::adjacent_find(publics.begin(), publics.end()) == publics.end());
+
+  auto &pair = pairs.back();
+  auto signature = pair.sign("generated");
+  EXPECT_TRUE(signature->verify("generated", pair.get_public_key()));
+}
+
+TEST(TEST_API, ephemeral_exchange) {
+
+  // RFC 7748, 6.1
+  auto private_of = [](const char *hex) {
+      ed25519::Data<ed25519::size::exchange_key> scalar;
+      EXPECT_TRUE(scalar.from_hex(hex));
+      return scalar.encode();
+  };
+
+  auto alice = ed25519::keys::Ephemeral::FromPrivateKey(
+          private_of("77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a"));
+  auto bob = ed25519::keys::Ephemeral::FromPrivateKey(
+          private_of("5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb"));
+  ASSERT_TRUE(alice);
+  ASSERT_TRUE(bob);
+
+  EXPECT_EQ(alice->get_public_key().to_hex(), "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a");
+  EXPECT_EQ(bob->get_public_key().to_hex(), "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f");
+
+  auto shared = "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742";
+  EXPECT_EQ(alice->exchange(bob->get_public_key()).to_hex(), shared);
+  EXPECT_EQ(bob->exchange(alice->get_public_key()).to_hex(), shared);
+
+  // the fixed-base key equals the ladder over the base point u = 9
+  ed25519::keys::ExchangeKey base;
+  base[0] = 9;
+  for (int k = 0; k < 20; ++k) {
+    auto ephemeral = ed25519::keys::Ephemeral::Random();
+    ASSERT_TRUE(ephemeral);
+    EXPECT_EQ(ephemeral->exchange(base), ephemeral->get_public_key());
+  }
+
+  // an ed25519 public key is exchanged as by ed25519_key_exchange
+  auto pair = ed25519::keys::Pair::WithSecret("some secret phrase");
+  auto a = ed25519::keys::Ephemeral::Random();
+  auto b = ed25519::keys::Ephemeral::Random();
+  EXPECT_EQ(a->exchange(pair->get_public_key()), a->exchange(pair->get_public_key()));
+  EXPECT_NE(a->exchange(pair->get_public_key()), b->exchange(pair->get_public_key()));
+
+  std::string message;
+  EXPECT_FALSE(ed25519::keys::Ephemeral::FromPrivateKey("", [&](const std::error_code &code){
+      message = code.message();
+  }));
+  EXPECT_EQ(message, "private key is empty");
+}
+
+TEST(TEST_API, pair_exchange) {
+
+  auto alice = ed25519::keys::Pair::Random();
+  auto bob = ed25519::keys::Pair::Random();
+
+  auto secret = alice->exchange(bob->get_public_key());
+  EXPECT_EQ(secret, bob->exchange(alice->get_public_key()));
+
+  ed25519::keys::PreparedPeer prepared(bob->get_public_key());
+  EXPECT_EQ(prepared.get_public_key(), bob->get_public_key());
+  EXPECT_EQ(alice->exchange(prepared), secret);
+
+  // a pair answers the ephemeral key of a handshake
+  auto ephemeral = ed25519::keys::Ephemeral::Random();
+  EXPECT_EQ(alice->exchange(ephemeral->get_public_key()), ephemeral->exchange(alice->get_public_key()));
+
+  // odd count with the identity point y = 1, it does not spoil the shared inversion
+  std::vector<ed25519::keys::Public> peers;
+  for (auto &pair: ed25519::keys::Pair::Generate(100))
+    peers.push_back(pair.get_public_key());
+  std::array<unsigned char, ed25519::size::public_key> identity{};
+  identity[0] = 1;
+  peers.insert(peers.begin() + 10, ed25519::keys::Public(identity));
+
+  auto batch = ed25519::keys::PreparedPeer::Prepare(peers);
+  ASSERT_EQ(batch.size(), peers.size());
+  for (size_t i = 0; i < peers.size(); ++i) {
+    EXPECT_EQ(batch[i].get_public_key(), peers[i]);
+    EXPECT_EQ(batch[i].get_exchange_key(), ed25519::keys::PreparedPeer(peers[i]).get_exchange_key());
+    EXPECT_EQ(alice->exchange(batch[i]), alice->exchange(peers[i]));
+  }
+
+  EXPECT_TRUE(ed25519::keys::PreparedPeer::Prepare({}).empty());
+}
+
+TEST(TEST_API, derive) {
+
+  auto parent = ed25519::keys::Pair::WithSecret("some secret phrase");
+
+  ed25519::keys::Tweak tweak{};
+  tweak[0] = 1;
+  tweak[31] = 0xff; // the highest bit is ignored
+
+  auto child = parent->derive(tweak);
+  EXPECT_TRUE(child.validate());
+  EXPECT_NE(child.get_public_key(), parent->get_public_key());
+
+  // watch-only derivation gives the public key of the derived pair
+  auto watched = parent->get_public_key().derive(tweak);
+  ASSERT_TRUE(watched);
+  EXPECT_EQ(*watched, child.get_public_key());
+
+  auto signature = child.sign("child");
+  EXPECT_TRUE(signature->verify("child", *watched));
+
+  auto prepared = ed25519::keys::PreparedParent::Prepare(parent->get_public_key());
+  ASSERT_TRUE(prepared);
+  EXPECT_EQ(prepared->get_public_key(), parent->get_public_key());
+  EXPECT_EQ(prepared->derive(tweak), child.get_public_key());
+
+  // odd count on several threads
+  std::vector<ed25519::keys::Tweak> tweaks(1000 + 7);
+  for (size_t i = 0; i < tweaks.size(); ++i) {
+    auto digest = ed25519::Digest([i](auto &calculator){ calculator.append(std::to_string(i)); });
+    std::copy(digest.begin(), digest.end(), tweaks[i].begin());
+  }
+
+  auto children = prepared->derive(tweaks, 3);
+  ASSERT_EQ(children.size(), tweaks.size());
+  for (size_t i = 0; i < tweaks.size(); ++i) {
+    EXPECT_EQ(children[i], parent->derive(tweaks[i]).get_public_key());
+  }
+
+  EXPECT_TRUE(prepared->derive(std::vector<ed25519::keys::Tweak>()).empty());
+
+  // small y without x on the curve
+  std::array<unsigned char, ed25519::size::public_key> bad{};
+  for (bad[0] = 2; ed25519::keys::Public(bad).validate(); ++bad[0]) {}
+  std::string message;
+  EXPECT_FALSE(ed25519::keys::PreparedParent::Prepare(ed25519::keys::Public(bad), [&](const std::error_code &code){
+      message = code.message();
+  }));
+  EXPECT_EQ(message, "public key is not a curve point");
+  EXPECT_FALSE(ed25519::keys::Public(bad).derive(tweak));
+}
+
+TEST(TEST_API, verify_cache) {
+
+  EXPECT_FALSE(ed25519::verify_cache::enabled());
+  EXPECT_EQ(ed25519::verify_cache::stats().capacity, 0u);
+
+  auto pair = ed25519::keys::Pair::Random();
+  auto other = ed25519::keys::Pair::Random();
+  auto signature = pair->sign("gossip");
+
+  ASSERT_TRUE(ed25519::verify_cache::enable(1000));
+  ASSERT_TRUE(ed25519::verify_cache::enabled());
+  EXPECT_EQ(ed25519::verify_cache::stats().capacity, 1024u);
+
+  EXPECT_TRUE(signature->verify("gossip", pair->get_public_key()));
+  EXPECT_TRUE(signature->verify("gossip", pair->get_public_key()));
+  EXPECT_TRUE(signature->verify("gossip", pair->get_public_key()));
+
+  auto stats = ed25519::verify_cache::stats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.insertions, 1u);
+  EXPECT_NEAR(stats.hit_rate(), 2.0 / 3, 1e-9);
+
+  // failures are never cached, a cached triple does not accept another key or message
+  for (int k = 0; k < 2; ++k) {
+    EXPECT_FALSE(signature->verify("gossip", other->get_public_key()));
+    EXPECT_FALSE(signature->verify("gossip!", pair->get_public_key()));
+  }
+  stats = ed25519::verify_cache::stats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.insertions, 1u);
+
+  // bounded: more triples than entries
+  for (int k = 0; k < 3000; ++k) {
+    auto message = std::to_string(k);
+    auto digest = ed25519::Digest([&](auto &calculator){ calculator.append(message); });
+    auto s = pair->sign(digest);
+    EXPECT_TRUE(s->verify(digest, pair->get_public_key()));
+    EXPECT_TRUE(s->verify(digest, pair->get_public_key()));
+  }
+  stats = ed25519::verify_cache::stats();
+  EXPECT_EQ(stats.capacity, 1024u);
+  EXPECT_EQ(stats.hits, 2u + 3000u);
+
+  ed25519::verify_cache::clear();
+  EXPECT_EQ(ed25519::verify_cache::stats().hits, 0u);
+  EXPECT_TRUE(signature->verify("gossip", pair->get_public_key()));
+  EXPECT_EQ(ed25519::verify_cache::stats().misses, 1u);
+
+  // shared between threads
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+        for (int k = 0; k < 50; ++k) EXPECT_TRUE(signature->verify("gossip", pair->get_public_key()));
+    });
+  }
+  for (auto &thread: threads) thread.join();
+  EXPECT_EQ(ed25519::verify_cache::stats().hits, 200u);
+
+  // replaced while other threads read it
+  std::atomic<bool> resizing(true);
+  threads.clear();
+  for (int t = 0; t < 3; ++t) {
+    threads.emplace_back([&] {
+        while (resizing.load()) EXPECT_TRUE(signature->verify("gossip", pair->get_public_key()));
+    });
+  }
+  for (int k = 0; k < 100; ++k) {
+    if (k % 10 == 9) ed25519::verify_cache::disable();
+    else EXPECT_TRUE(ed25519::verify_cache::enable(64 + k));
+  }
+  resizing.store(false);
+  for (auto &thread: threads) thread.join();
+  EXPECT_EQ(ed25519::verify_cache::stats().capacity, 0u);
+  EXPECT_TRUE(ed25519::verify_cache::enable(1000));
+
+  // an absurd size is refused instead of overflowing the bucket count
+  EXPECT_FALSE(ed25519::verify_cache::enable(SIZE_MAX));
+  EXPECT_FALSE(ed25519::verify_cache::enabled());
+  EXPECT_TRUE(signature->verify("gossip", pair->get_public_key()));
+
+  ed25519::verify_cache::disable();
+  EXPECT_FALSE(ed25519::verify_cache::enabled());
+  EXPECT_TRUE(signature->verify("gossip", pair->get_public_key()));
+  EXPECT_EQ(ed25519::verify_cache::stats().hits, 0u);
+}
+
+TEST(TEST_API, verifier) {
+
+  auto pair = ed25519::keys::Pair::Random();
+  auto other = ed25519::keys::Pair::Random();
+
+  // mixed sizes, every third signature belongs to another key
+  std::vector<std::string> messages;
+  std::vector<std::unique_ptr<ed25519::Signature>> signatures;
+  for (size_t k = 0; k < 300; ++k) {
+    messages.push_back(std::string(k * 37 % 5000, static_cast<char>('a' + k % 26)));
+    signatures.push_back(k % 3 == 0 ? other->sign(messages.back()) : pair->sign(messages.back()));
+  }
+
+  std::vector<int> results(messages.size(), -1);
+  std::atomic<size_t> completed(0);
+
+  {
+    // tiny queues: submitters and the hash stage block on full queues
+    ed25519::Verifier verifier(2, 2, 2);
+
+    for (size_t k = 0; k < messages.size(); ++k) {
+      verifier.submit(*signatures[k], pair->get_public_key(), messages[k], [&results, &completed, k](bool verified) {
+          results[k] = verified;
+          completed.fetch_add(1);
+      });
+    }
+
+    verifier.wait();
+    EXPECT_EQ(completed.load(), messages.size());
+
+    // requests submitted before destruction are completed
+    for (size_t k = 0; k < 10; ++k) {
+      std::vector<unsigned char> message(messages[k].begin(), messages[k].end());
+      while (!verifier.try_submit(*signatures[k], pair->get_public_key(), message, [&completed](bool) {
+          completed.fetch_add(1);
+      })) std::this_thread::yield();
+    }
+    for (size_t k = 10; k < 20; ++k) {
+      while (!verifier.try_submit(*signatures[k], pair->get_public_key(), std::string_view(messages[k]),
+                                  [&completed](bool) { completed.fetch_add(1); })) std::this_thread::yield();
+    }
+  }
+
+  EXPECT_EQ(completed.load(), messages.size() + 20);
+
+  for (size_t k = 0; k < messages.size(); ++k) {
+    EXPECT_EQ(results[k], k % 3 != 0 ? 1 : 0);
+    EXPECT_EQ(results[k] == 1, signatures[k]->verify(messages[k], pair->get_public_key()));
+  }
+
+  // verification cache hits complete after hashing
+  ed25519::verify_cache::enable();
+  {
+    ed25519::Verifier verifier;
+    std::atomic<size_t> verified(0);
+    for (int copy = 0; copy < 2; ++copy) {
+      for (size_t k = 1; k < 30; k += 3) {
+        verifier.submit(*signatures[k], pair->get_public_key(), messages[k], [&verified](bool ok) { verified += ok; });
+      }
+      verifier.wait();
+    }
+    EXPECT_EQ(verified.load(), 20u);
+    EXPECT_EQ(ed25519::verify_cache::stats().hits, 10u);
+  }
+  ed25519::verify_cache::disable();
+}
+
+TEST(TEST_API, memory_resource) {
+
+  auto pair = ed25519::keys::Pair::WithSecret("some secret phrase");
+  auto digest = ed25519::Digest([](auto &calculator) { calculator.append(std::string_view("abc")); });
+
+  // a fixed arena without upstream: anything that does not fit throws std::bad_alloc
+  std::array<unsigned char, 4096> buffer{};
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+  std::pmr::string message("a request body longer than the small string buffer", &arena);
+
+  auto signature = pair->sign(message, &arena);
+  EXPECT_EQ(*signature, *pair->sign(std::string(message)));
+  EXPECT_TRUE(signature->verify(message, pair->get_public_key()));
+
+  auto signed_digest = pair->sign(digest, &arena);
+  EXPECT_EQ(*signed_digest, *pair->sign(digest));
+
+  std::vector<unsigned char> bytes(message.begin(), message.end());
+  EXPECT_EQ(*pair->sign(bytes, &arena), *signature);
+
+  auto encoded = signature->encode(&arena);
+  EXPECT_EQ(std::string_view(encoded), signature->encode());
+  EXPECT_EQ(encoded.get_allocator().resource(), &arena);
+  EXPECT_EQ(std::string_view(pair->get_public_key().encode(&arena)), pair->get_public_key().encode());
+  EXPECT_EQ(std::string_view(digest.to_hex(&arena)), digest.to_hex());
+
+  auto decoded = ed25519::Signature::TryDecode(encoded);
+  ASSERT_TRUE(decoded);
+  EXPECT_EQ(*decoded, *signature);
+
+  EXPECT_THROW({
+    std::pmr::monotonic_buffer_resource small(buffer.data(), 16, std::pmr::null_memory_resource());
+    auto unused = pair->sign(message, &small);
+  }, std::bad_alloc);
+}
+
+TEST(TEST_API, plain_bytes) {
+
+  static_assert(sizeof(ed25519::PublicKeyBytes) == ed25519::size::public_key, "no padding");
+  static_assert(sizeof(ed25519::SignatureBytes) == ed25519::size::signature, "no padding");
+  static_assert(std::is_trivially_copyable<ed25519::SignatureBytes>::value, "memcpy-able");
+
+  auto pair = ed25519::keys::Pair::Random();
+  ASSERT_TRUE(pair);
+
+  std::string message = "a record stored next to its signature";
+
+  auto key = pair->get_public_key().bytes();
+  EXPECT_EQ(ed25519::keys::Public(key), pair->get_public_key());
+
+  auto signature = pair->sign_bytes(message);
+  EXPECT_EQ(ed25519::Signature(signature), *pair->sign(message));
+  EXPECT_EQ(pair->sign(message)->bytes(), signature);
+
+  EXPECT_TRUE(ed25519::verify(signature, message, key));
+  EXPECT_TRUE(ed25519::Signature(signature).verify(message, key));
+  EXPECT_FALSE(ed25519::verify(signature, "another record", key));
+
+  auto digest = ed25519::Digest([&message](auto &calculator) { calculator.append(message); });
+  auto signed_digest = pair->sign_bytes(digest.bytes());
+  EXPECT_EQ(signed_digest, pair->sign(digest)->bytes());
+  EXPECT_TRUE(ed25519::verify(signed_digest, digest.bytes(), key));
+  EXPECT_TRUE(ed25519::Signature(signed_digest).verify(digest, key));
+  EXPECT_EQ(ed25519::Digest(digest.bytes()), digest);
+
+  std::vector<ed25519::PublicKeyBytes> keys(3, key);
+  std::vector<ed25519::PublicKeyBytes> copies(keys.size());
+  std::memcpy(copies.data(), keys.data(), keys.size() * sizeof(ed25519::PublicKeyBytes));
+  EXPECT_EQ(copies, keys);
+
+  EXPECT_EQ(ed25519::base58::encode_fixed(key).str(), pair->get_public_key().encode());
+  auto encoded = ed25519::base58::encode_bulk(copies);
+  ASSERT_EQ(encoded.size(), 3);
+  EXPECT_EQ(std::string(encoded[2]), pair->get_public_key().encode());
+
+  std::atomic<int> verified(0);
+  {
+    ed25519::Verifier verifier(1, 1);
+    verifier.submit(signature, key, std::vector<unsigned char>(message.begin(), message.end()),
+                    [&verified](bool ok) { if (ok) verified++; });
+    verifier.submit(signature, key, std::string_view(message), [&verified](bool ok) { if (ok) verified++; });
+    while (!verifier.try_submit(signature, key, std::string_view(message), [&verified](bool ok) { if (ok) verified++; }))
+      std::this_thread::yield();
+    while (!verifier.try_submit(signature, key, std::vector<unsigned char>(message.begin(), message.end()),
+                                [&verified](bool ok) { if (ok) verified++; }))
+      std::this_thread::yield();
+    verifier.wait();
+  }
+  EXPECT_EQ(verified.load(), 4);
+
+  std::vector<unsigned char> bytes(message.begin(), message.end());
+  EXPECT_EQ(pair->sign_bytes(bytes), signature);
+
+  // key exchange and derivation take records as well
+  auto peer = ed25519::keys::Pair::Random();
+  auto peer_key = peer->get_public_key().bytes();
+  EXPECT_EQ(pair->exchange(peer_key), pair->exchange(peer->get_public_key()));
+  EXPECT_EQ(peer->exchange(key), pair->exchange(peer_key));
+
+  auto ephemeral = ed25519::keys::Ephemeral::Random();
+  ASSERT_TRUE(ephemeral);
+  EXPECT_EQ(ephemeral->exchange(key), ephemeral->exchange(pair->get_public_key()));
+
+  ed25519::keys::PreparedPeer prepared_peer(peer_key);
+  EXPECT_EQ(pair->exchange(prepared_peer), pair->exchange(peer_key));
+  auto prepared_peers = ed25519::keys::PreparedPeer::PrepareBytes({key, peer_key});
+  ASSERT_EQ(prepared_peers.size(), 2u);
+  EXPECT_EQ(prepared_peers[1].get_exchange_key(), prepared_peer.get_exchange_key());
+  EXPECT_EQ(prepared_peers[0].get_public_key(), pair->get_public_key());
+
+  ed25519::keys::Tweak tweak{};
+  tweak[0] = 42;
+  auto child = ed25519::keys::derive(key, tweak);
+  ASSERT_TRUE(child);
+  EXPECT_EQ(ed25519::keys::Public(*child), *pair->get_public_key().derive(tweak));
+
+  auto parent = ed25519::keys::PreparedParent::Prepare(key);
+  ASSERT_TRUE(parent);
+  EXPECT_EQ(parent->derive_bytes(tweak), *child);
+  std::vector<ed25519::keys::Tweak> tweaks(300, tweak);
+  for (size_t k = 0; k < tweaks.size(); ++k) tweaks[k][1] = static_cast<unsigned char>(k);
+  auto children = parent->derive_bytes(tweaks, 2);
+  auto objects = parent->derive(tweaks, 2);
+  ASSERT_EQ(children.size(), objects.size());
+  for (size_t k = 0; k < children.size(); ++k) EXPECT_EQ(children[k], objects[k].bytes());
+}
+
+#endif
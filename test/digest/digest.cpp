@@ -6,12 +6,26 @@
 #include "ed25519.hpp"
 #include <string>
 #include <iostream>
+#include <cstdlib>
+#include <new>
+#include <atomic>
 
 #include "gtest/gtest.h"
 #define GTEST_COUT std::cerr << "[          ] [ INFO ]"
 
 using namespace ed25519;
 
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
 auto error_handler = [](const std::error_code& code){
     GTEST_COUT << "Test error: " << ed25519::StringFormat("code: %i, message: %s", code.value(), + code.message().c_str()) << std::endl;
 };
@@ -54,4 +68,272 @@ TEST(TEST, digest_calculator) {
   std::optional<ed25519::keys::Public> pk = ed25519::keys::Public::Decode(pair->get_public_key().encode(), default_error_handler);
 
   GTEST_COUT << siganture->verify(*digest_restored, *pk) << std::endl;
-}
\ No newline at end of file
+}
+TEST(TEST, digest_bulk) {
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+
+  std::vector<Digest::context> records;
+
+  // cover empty records, exact rate boundaries and multi-block records
+  for (int i = 0; i < 37; ++i) {
+    records.emplace_back([&pair, i](auto &calculator) {
+        if (i % 5 == 0) return;
+        calculator.append(i);
+        calculator.append(std::string(static_cast<size_t>(i * 17 % 300), 'x'));
+        if (i % 3 == 0) {
+          calculator.append(pair->get_public_key());
+        }
+        if (i % 4 == 0) {
+          calculator.set_endian(Digest::Calculator::endian::big);
+          calculator.append((short int)i);
+        }
+    });
+  }
+  records.emplace_back([](auto &calculator) {
+      calculator.append(std::string(136, 'r'));
+  });
+  records.emplace_back([](auto &calculator) {
+      calculator.append(std::string(135, 'r'));
+  });
+
+  for (size_t count: {records.size(), size_t(1), size_t(3), size_t(6)}) {
+    std::vector<Digest::context> part(records.begin(), records.begin() + count);
+    auto digests = Digest::Bulk(part);
+
+    EXPECT_EQ(digests.size(), part.size());
+
+    for (size_t i = 0; i < part.size(); ++i) {
+      EXPECT_TRUE(digests[i] == Digest(part[i]));
+    }
+  }
+
+  EXPECT_TRUE(Digest::Bulk({}).empty());
+}
+
+static std::string to_hex(const Digest &digest) {
+  std::string hex;
+  for (auto c: digest) hex += StringFormat("%02x", c);
+  return hex;
+}
+
+TEST(TEST, digest_absorb) {
+
+  auto abc = Digest([](auto &calculator) {
+      calculator.append(std::string("abc"));
+  });
+
+  EXPECT_EQ(to_hex(abc), "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532");
+
+  std::vector<unsigned char> message(3000);
+  for (size_t i = 0; i < message.size(); ++i) message[i] = static_cast<unsigned char>(i % 251);
+
+  const std::string expected = "509bb1395d62e87a72110a36149d925343c18da098f0971c8fc3a09d87a3b60c";
+
+  // unaligned heads, partial blocks and whole blocks in every combination
+  for (size_t step: {size_t(1), size_t(3), size_t(7), size_t(8), size_t(13), size_t(136), size_t(137), size_t(500), message.size()}) {
+    auto digest = Digest([&message, step](auto &calculator) {
+        for (size_t offset = 0; offset < message.size(); offset += step) {
+          auto last = std::min(message.size(), offset + step);
+          calculator.append(std::vector<unsigned char>(message.begin() + offset, message.begin() + last));
+        }
+    });
+    EXPECT_EQ(to_hex(digest), expected) << "step: " << step;
+  }
+}
+
+TEST(TEST, digest_no_allocations) {
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  auto digest = Digest([](auto &calculator) { calculator.append(std::string_view("previous")); });
+  std::string title = "a title which is too long for the small string buffer";
+  std::vector<unsigned char> payload(1000, 0x5a);
+
+  auto record = [&](Digest::Calculator &calculator) {
+      calculator.append(true);
+      calculator.append((unsigned char)7);
+      calculator.append((short int)-2);
+      calculator.append(1000000);
+      calculator.append(title);
+      calculator.append(std::string_view("literal view"));
+      calculator.append(payload);
+      calculator.append(pair->get_public_key());
+      calculator.append(pair->get_private_key());
+      calculator.append(digest);
+  };
+
+  auto before = allocations.load();
+  Digest typed(record);
+  EXPECT_EQ(allocations.load(), before);
+
+  // the variant path must produce the same bytes
+  auto variant = Digest([&](Digest::Calculator &calculator) {
+      calculator.append(Digest::Calculator::variant_t(true));
+      calculator.append(Digest::Calculator::variant_t((unsigned char)7));
+      calculator.append(Digest::Calculator::variant_t((short int)-2));
+      calculator.append(Digest::Calculator::variant_t(1000000));
+      calculator.append(Digest::Calculator::variant_t(title));
+      calculator.append(Digest::Calculator::variant_t(std::string("literal view")));
+      calculator.append(Digest::Calculator::variant_t(payload));
+      calculator.append(Digest::Calculator::variant_t(Data<size::hash>(pair->get_public_key())));
+      calculator.append(Digest::Calculator::variant_t(Data<size::double_hash>(pair->get_private_key())));
+      calculator.append(Digest::Calculator::variant_t(Data<size::hash>(digest)));
+  });
+
+  EXPECT_TRUE(typed == variant);
+}
+
+TEST(TEST, digest_of) {
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  std::string title = "some title";
+  std::vector<unsigned char> payload(300, 0x11);
+
+  // fixed-width record: packed into one buffer
+  auto fixed = Digest::of(true, (unsigned char)3, (short int)-7, 123456, pair->get_public_key(), pair->get_private_key());
+  auto fixed_runtime = Digest([&](auto &calculator) {
+      calculator.append(true);
+      calculator.append((unsigned char)3);
+      calculator.append((short int)-7);
+      calculator.append(123456);
+      calculator.append(pair->get_public_key());
+      calculator.append(pair->get_private_key());
+  });
+  EXPECT_TRUE(fixed == fixed_runtime);
+
+  // variable-width record in big endian
+  auto mixed = Digest::of<Digest::Calculator::big>(123456, title, std::string_view("view"), payload, (short int)513, fixed);
+  auto mixed_runtime = Digest([&](auto &calculator) {
+      calculator.set_endian(Digest::Calculator::big);
+      calculator.append(123456);
+      calculator.append(title);
+      calculator.append(std::string_view("view"));
+      calculator.append(payload);
+      calculator.append((short int)513);
+      calculator.append(fixed);
+  });
+  EXPECT_TRUE(mixed == mixed_runtime);
+  EXPECT_TRUE(mixed != Digest::of(123456, title, std::string_view("view"), payload, (short int)513, fixed));
+
+  EXPECT_TRUE(Digest::of() == Digest([](auto &) {}));
+}
+
+TEST(TEST, digest_prefix) {
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  std::string header(1000, 'h');
+
+  Digest::Prefix prefix([&](auto &calculator) {
+      calculator.append(42);
+      calculator.append(header);
+      calculator.append(pair->get_public_key());
+      calculator.set_endian(Digest::Calculator::big);
+  });
+
+  for (int nonce = 0; nonce < 10; ++nonce) {
+    auto digest = prefix.finish([nonce](auto &calculator) {
+        calculator.append(nonce);
+        calculator.append(std::string_view("tail"));
+    });
+
+    auto full = Digest([&](auto &calculator) {
+        calculator.append(42);
+        calculator.append(header);
+        calculator.append(pair->get_public_key());
+        calculator.set_endian(Digest::Calculator::big);
+        calculator.append(nonce);
+        calculator.append(std::string_view("tail"));
+    });
+
+    EXPECT_TRUE(digest == full);
+  }
+
+  Digest::context tail = [](Digest::Calculator &calculator) { calculator.append(true); };
+  EXPECT_TRUE(prefix.finish(tail) == prefix.finish([](auto &calculator) { calculator.append(true); }));
+
+  EXPECT_TRUE(prefix.finish() == Digest([&](auto &calculator) {
+      calculator.append(42);
+      calculator.append(header);
+      calculator.append(pair->get_public_key());
+  }));
+}
+
+TEST(TEST, digest_parallel_hash) {
+  // SP 800-185 ParallelHash256 samples with 256-bit output
+  std::vector<unsigned char> sample = {
+          0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+          0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+          0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27};
+
+  EXPECT_EQ(to_hex(Digest::ParallelHash(sample, 8)),
+            "21cfe3c7698c57286f6146f662cddd507ac51ced3db1b571ae8f836bf23a25dd");
+  EXPECT_EQ(to_hex(Digest::ParallelHash(sample, 8, 0, "Parallel Data")),
+            "2992a283de7c6ce819dc6948d405fc7d5c488db3c27236a9f67994252294a0c0");
+  EXPECT_EQ(to_hex(Digest::ParallelHash(std::vector<unsigned char>())),
+            "b21d6e1ad6d55c93b8f4653cecdf58be4cf486aede65f0228d908947ec0e4812");
+
+  std::vector<unsigned char> payload(100000);
+  for (size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<unsigned char>(i % 251);
+
+  for (size_t threads: {size_t(1), size_t(3), size_t(0)}) {
+    EXPECT_EQ(to_hex(Digest::ParallelHash(payload, 8192, threads)),
+              "4f2cf63721f0c0024a16c183db41654978114db090c1141fbf726c697bface51");
+    EXPECT_EQ(to_hex(Digest::ParallelHash(payload, 1000, threads)),
+              "8172df18764a02632ad2110ef27a41344040e3408085f56c9cbdc1e097f2f878");
+  }
+
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  auto digest = Digest::ParallelHash(payload);
+  EXPECT_TRUE(pair->sign(digest)->verify(digest, pair->get_public_key()));
+
+  EXPECT_THROW(Digest::ParallelHash(payload, 0), std::invalid_argument);
+}
+
+TEST(TEST, digest_blake3) {
+  // BLAKE3 test vectors, input bytes are i % 251
+  std::vector<std::pair<size_t, std::string>> vectors = {
+          {0,       "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"},
+          {1,       "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213"},
+          {1023,    "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11"},
+          {1024,    "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7"},
+          {1025,    "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"},
+          {2048,    "e776b6028c7cd22a4d0ba182a8bf62205d2ef576467e838ed6f2529b85fba24a"},
+          {2049,    "5f4d72f40d7a5f82b15ca2b2e44b1de3c2ef86c426c95c1af0b6879522563030"},
+          {3073,    "7124b49501012f81cc7f11ca069ec9226cecb8a2c850cfe644e327d22d3e1cd3"},
+          {8192,    "aae792484c8efe4f19e2ca7d371d8c467ffb10748d8a5a1ae579948f718a2a63"},
+          {8193,    "bab6c09cb8ce8cf459261398d2e7aef35700bf488116ceb94a36d0f5f1b7bc3b"},
+          {16384,   "f875d6646de28985646f34ee13be9a576fd515f76b5b0a26bb324735041ddde4"},
+          {31744,   "62b6960e1a44bcc1eb1a611a8d6235b6b4b78f32e7abc4fb4c6cdcce94895c47"},
+          {102400,  "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085"},
+          {1000000, "5e82c663d164c54e4fcdfcd70e3ca464662228bdbad45cce2e0c2bff999064ef"}
+  };
+
+  for (auto &[size, expected]: vectors) {
+    std::vector<unsigned char> input(size);
+    for (size_t i = 0; i < size; ++i) input[i] = static_cast<unsigned char>(i % 251);
+
+    EXPECT_EQ(to_hex(Digest([&input](auto &calculator) {
+        calculator.append(input);
+    }, Digest::blake3)), expected) << size;
+
+    // odd pieces cross block, chunk and subtree boundaries
+    EXPECT_EQ(to_hex(Digest([&input](auto &calculator) {
+        std::string_view bytes(reinterpret_cast<const char *>(input.data()), input.size());
+        for (size_t offset = 0, step = 1; offset < bytes.size(); offset += step, step = step * 7 + 13) {
+          calculator.append(bytes.substr(offset, step));
+        }
+    }, Digest::blake3)), expected) << size;
+
+    for (size_t threads: {size_t(1), size_t(3), size_t(0)}) {
+      EXPECT_EQ(to_hex(Digest::Blake3(input, threads)), expected) << size;
+    }
+  }
+
+  EXPECT_EQ(to_hex(Digest([](auto &calculator) {
+      calculator.append(std::string_view("abc"));
+  }, Digest::blake3)), "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85");
+
+  Digest::context context = [](Digest::Calculator &calculator) {
+      calculator.append(1);
+      calculator.append(std::string("record"));
+  };
+  EXPECT_EQ(Digest(context, Digest::blake3), Digest([&context](auto &calculator) { context(calculator); }, Digest::blake3));
+  EXPECT_NE(Digest(context, Digest::blake3), Digest(context));
+  EXPECT_EQ(Digest(context, Digest::sha3_256), Digest(context));
+}
@@ -0,0 +1,174 @@
+//
+// Base58 and hex codec rates of fixed-size keys
+//
+
+#include "ed25519.hpp"
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace ed25519;
+
+template<typename Function>
+static float seconds_of(int nc, Function &&function) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int k = 0; k < nc; ++k) function();
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = finish - start;
+  return (float)elapsed.count()/1000;
+}
+
+template<size_t N>
+static void base58_rate(const Data<N> &data, int nc) {
+
+  std::vector<unsigned char> vch(data.begin(), data.end());
+  auto crc = base58::crc32(vch.data(), vch.size());
+  for (int i = 0; i < 4; ++i) vch.push_back(static_cast<unsigned char>((crc >> (8 * i)) & 0xff));
+
+  auto encoded = data.encode();
+  size_t total = 0;
+
+  auto diff = seconds_of(nc, [&] { total += base58::crc32(data.data(), N); });
+  std::cout << "base58[" << N << "b] crc32 alone   : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "cps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += base58::encode(vch).size(); });
+  std::cout << "base58[" << N << "b] generic encode (no crc): " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += data.encode_fixed().size(); });
+  std::cout << "base58[" << N << "b] fixed encode  : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += data.encode().size(); });
+  std::cout << "base58[" << N << "b] Data::encode  : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  std::vector<unsigned char> decoded_vector;
+  diff = seconds_of(nc, [&] { total += base58::decode(encoded, decoded_vector); });
+  std::cout << "base58[" << N << "b] generic decode: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" << std::endl;
+
+  std::array<unsigned char, N> decoded{};
+  diff = seconds_of(nc, [&] { total += base58::decode_fixed(encoded, decoded); });
+  std::cout << "base58[" << N << "b] fixed decode  : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += base58::validate(encoded); });
+  std::cout << "base58[" << N << "b] validate      : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "vps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += base58::validate<N>(encoded); });
+  std::cout << "base58[" << N << "b] validate<N>   : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "vps" << std::endl;
+
+  EXPECT_TRUE(total > 0);
+}
+
+TEST(TEST, base58_rate){
+  auto pair = keys::Pair::Random();
+  base58_rate(pair->get_public_key(), 200000);
+  base58_rate(pair->get_private_key(), 100000);
+}
+
+TEST(TEST, crc32_rate){
+  std::vector<unsigned char> buffer(1024*1024, 0x5a);
+  int nc = 200;
+  uint_least32_t crc = 0;
+
+  auto diff = seconds_of(nc, [&] { crc ^= base58::crc32(buffer.data(), buffer.size()); });
+  std::cout << "crc32[1MB]: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "MB/s" << std::endl;
+
+  EXPECT_TRUE(crc != 1);
+}
+
+TEST(TEST, base58_bulk_rate){
+  std::vector<keys::Public> keys;
+  for (int k = 0; k < 100000; ++k) keys.push_back(keys::Pair::Random()->get_public_key());
+  int nc = 5;
+  size_t total = 0;
+
+  auto diff = seconds_of(nc, [&] { for (auto &key: keys) total += key.encode().size(); });
+  std::cout << "base58[32b] one by one encode: " << nc * keys.size() << " time: " << diff << "sec, " << float(nc * keys.size())/diff << "eps" << std::endl;
+
+  for (size_t threads: {1, 0}) {
+    diff = seconds_of(nc, [&] { total += base58::encode_bulk(keys, threads).size(); });
+    std::cout << "base58[32b] bulk encode[" << threads << "]: " << nc * keys.size() << " time: " << diff << "sec, " << float(nc * keys.size())/diff << "eps" << std::endl;
+  }
+
+  auto list = base58::encode_bulk(keys);
+  diff = seconds_of(nc, [&] { for (size_t i = 0; i < list.size(); ++i) total += keys::Public::Decode(std::string(list[i])).has_value(); });
+  std::cout << "base58[32b] one by one decode: " << nc * keys.size() << " time: " << diff << "sec, " << float(nc * keys.size())/diff << "dps" << std::endl;
+
+  std::vector<std::array<unsigned char, size::public_key>> decoded;
+  for (size_t threads: {1, 0}) {
+    diff = seconds_of(nc, [&] { total += base58::decode_bulk(list.buffer, decoded, threads); });
+    std::cout << "base58[32b] bulk decode[" << threads << "]: " << nc * keys.size() << " time: " << diff << "sec, " << float(nc * keys.size())/diff << "dps" << std::endl;
+  }
+
+  EXPECT_TRUE(total > 0);
+}
+
+TEST(TEST, hex_rate){
+  auto pair = keys::Pair::Random();
+  auto signature = pair->sign(std::string("message"));
+  int nc = 1000000;
+  size_t total = 0;
+
+  auto diff = seconds_of(nc / 10, [&] {
+      std::stringstream s;
+      s << std::hex;
+      for (auto c: *signature) s << std::setw(2) << std::setfill('0') << (unsigned int) c;
+      total += s.str().size();
+  });
+  std::cout << "hex[64b] stringstream encode: " << nc / 10 << " time: " << diff << "sec, " << float(nc / 10)/diff << "eps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += signature->to_hex().size(); });
+  std::cout << "hex[64b] to_hex             : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  auto hex = signature->to_hex();
+  diff = seconds_of(nc, [&] { total += Signature::FromHex(hex).has_value(); });
+  std::cout << "hex[64b] FromHex            : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" << std::endl;
+
+  std::vector<unsigned char> buffer(1024*1024, 0x5a);
+  std::string text(2 * buffer.size(), '0');
+  diff = seconds_of(200, [&] { hex::encode(buffer.data(), buffer.size(), text.data()); });
+  std::cout << "hex[1MB] encode: " << 200 << " time: " << diff << "sec, " << float(200)/diff << "MB/s" << std::endl;
+  diff = seconds_of(200, [&] { total += hex::decode(text, buffer.data(), buffer.size()); });
+  std::cout << "hex[1MB] decode: " << 200 << " time: " << diff << "sec, " << float(200)/diff << "MB/s" << std::endl;
+
+  EXPECT_TRUE(total > 0);
+}
+
+TEST(TEST, encoded_memo_rate){
+  auto pair = keys::Pair::Random();
+  keys::EncodedPublic key(pair->get_public_key());
+  int nc = 1000000;
+  size_t total = 0;
+
+  auto diff = seconds_of(nc, [&] { total += pair->get_public_key().encode().size(); });
+  std::cout << "base58[32b] Public::encode       : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += key.encode().size(); });
+  std::cout << "base58[32b] EncodedPublic::encode: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  EXPECT_TRUE(total > 0);
+}
+
+TEST(TEST, try_decode_rate){
+  auto pair = keys::Pair::Random();
+  auto garbage = pair->get_public_key().encode();
+  garbage[10] = garbage[10] == 'z' ? 'y' : 'z';
+  int nc = 200000;
+  size_t total = 0;
+
+  auto diff = seconds_of(nc, [&] {
+      total += keys::Public::Decode(garbage, [&](const std::error_code &code) { total += code.value(); }).has_value();
+  });
+  std::cout << "base58[32b] garbage Decode   : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += keys::Public::TryDecode(garbage).error().code; });
+  std::cout << "base58[32b] garbage TryDecode: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" << std::endl;
+
+  auto encoded = pair->get_public_key().encode();
+  diff = seconds_of(nc, [&] { total += keys::Public::TryDecode(encoded).has_value(); });
+  std::cout << "base58[32b] valid TryDecode  : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" << std::endl;
+
+  EXPECT_TRUE(total > 0);
+}
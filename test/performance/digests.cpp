@@ -0,0 +1,234 @@
+//
+// Created by denn on 2019-01-30.
+//
+
+#include "ed25519.hpp"
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <string>
+#include <iostream>
+
+using namespace ed25519;
+
+TEST(TEST, digest_rate){
+
+  std::vector<std::pair<size_t, int>> tests = {{32, 1000000}, {1024, 100000}, {1024*1024, 100}};
+
+  for(auto [size, nc]: tests ) {
+
+    std::vector<unsigned char> message(size, 0xa5);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Digest digest;
+    for (int k = 0; k < nc; ++k) {
+      digest = Digest([&message](auto &calculator) {
+          calculator.append(message);
+      });
+    }
+
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = finish - start;
+
+    auto diff = (float)elapsed.count()/1000;
+
+    std::cout << "digests[message size="<<size<<"b]: " << nc << " time: " << diff << "sec, "
+              << float(nc)/diff << "dps, " << float(size)*float(nc)/diff/1024/1024 << "MB/s" <<std::endl;
+  }
+}
+
+TEST(TEST, digest_bulk_rate){
+
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  int nc = 100000;
+
+  std::vector<Digest::context> records;
+  records.reserve(nc);
+  for (int k = 0; k < nc; ++k) {
+    records.emplace_back([&pair, k](auto &calculator) {
+        calculator.append(k);
+        calculator.append(true);
+        calculator.append(pair->get_public_key());
+        calculator.append((short int)(k & 0xffff));
+    });
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  std::vector<Digest> single;
+  single.reserve(nc);
+  for (auto &record: records) {
+    single.emplace_back(record);
+  }
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = finish - start;
+  auto diff = (float)elapsed.count()/1000;
+
+  std::cout << "digests one by one: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" <<std::endl;
+
+  start = std::chrono::high_resolution_clock::now();
+
+  auto bulk = Digest::Bulk(records);
+
+  finish = std::chrono::high_resolution_clock::now();
+  elapsed = finish - start;
+  diff = (float)elapsed.count()/1000;
+
+  std::cout << "digests bulk      : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" <<std::endl;
+
+  EXPECT_TRUE(bulk == single);
+}
+
+TEST(TEST, digest_of_rate){
+
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  int nc = 1000000;
+  Digest digest;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for (int k = 0; k < nc; ++k) {
+    digest = Digest([&pair, k](auto &calculator) {
+        calculator.append(k);
+        calculator.append(true);
+        calculator.append(pair->get_public_key());
+        calculator.append((short int)(k & 0x7fff));
+    });
+  }
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = finish - start;
+  auto diff = (float)elapsed.count()/1000;
+
+  std::cout << "digests calculator: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" <<std::endl;
+
+  start = std::chrono::high_resolution_clock::now();
+
+  for (int k = 0; k < nc; ++k) {
+    digest = Digest::of(k, true, pair->get_public_key(), (short int)(k & 0x7fff));
+  }
+
+  finish = std::chrono::high_resolution_clock::now();
+  elapsed = finish - start;
+  diff = (float)elapsed.count()/1000;
+
+  std::cout << "digests of        : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" <<std::endl;
+}
+
+TEST(TEST, digest_prefix_rate){
+
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  std::string header(4096, 'h');
+  int nc = 100000;
+  Digest digest;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for (int k = 0; k < nc; ++k) {
+    digest = Digest([&](auto &calculator) {
+        calculator.append(header);
+        calculator.append(pair->get_public_key());
+        calculator.append(k);
+    });
+  }
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = finish - start;
+  auto diff = (float)elapsed.count()/1000;
+
+  std::cout << "digests[prefix=4KB] full  : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" <<std::endl;
+
+  start = std::chrono::high_resolution_clock::now();
+
+  Digest::Prefix prefix([&](auto &calculator) {
+      calculator.append(header);
+      calculator.append(pair->get_public_key());
+  });
+
+  for (int k = 0; k < nc; ++k) {
+    digest = prefix.finish([k](auto &calculator) {
+        calculator.append(k);
+    });
+  }
+
+  finish = std::chrono::high_resolution_clock::now();
+  elapsed = finish - start;
+  diff = (float)elapsed.count()/1000;
+
+  std::cout << "digests[prefix=4KB] prefix: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "dps" <<std::endl;
+}
+
+TEST(TEST, digest_parallel_hash_rate){
+
+  std::vector<unsigned char> payload(64*1024*1024, 0x5a);
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  auto sequential = Digest([&payload](auto &calculator) {
+      calculator.append(payload);
+  });
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = finish - start;
+  auto diff = (float)elapsed.count()/1000;
+
+  std::cout << "digest[64MB] sha3-256          : " << diff << "sec, " << 64/diff << "MB/s" <<std::endl;
+
+  for (size_t threads: {size_t(1), size_t(0)}) {
+    start = std::chrono::high_resolution_clock::now();
+
+    auto parallel = Digest::ParallelHash(payload, 8192, threads);
+
+    finish = std::chrono::high_resolution_clock::now();
+    elapsed = finish - start;
+    diff = (float)elapsed.count()/1000;
+
+    std::cout << "digest[64MB] parallel hash[threads=" << threads << "]: " << diff << "sec, " << 64/diff << "MB/s" <<std::endl;
+  }
+}
+
+TEST(TEST, digest_blake3_rate){
+
+  std::vector<std::pair<size_t, int>> tests = {{32, 1000000}, {1024, 100000}, {1024*1024, 100}};
+
+  for(auto [size, nc]: tests ) {
+
+    std::vector<unsigned char> message(size, 0xa5);
+
+    for (auto hash: {Digest::sha3_256, Digest::blake3}) {
+      auto start = std::chrono::high_resolution_clock::now();
+
+      Digest digest;
+      for (int k = 0; k < nc; ++k) {
+        digest = Digest([&message](auto &calculator) {
+            calculator.append(message);
+        }, hash);
+      }
+
+      auto finish = std::chrono::high_resolution_clock::now();
+      std::chrono::duration<double, std::milli> elapsed = finish - start;
+
+      auto diff = (float)elapsed.count()/1000;
+
+      std::cout << (hash == Digest::blake3 ? "blake3  " : "sha3-256") << " digests[message size="<<size<<"b]: "
+                << nc << " time: " << diff << "sec, "
+                << float(nc)/diff << "dps, " << float(size)*float(nc)/diff/1024/1024 << "MB/s" <<std::endl;
+    }
+  }
+
+  std::vector<unsigned char> payload(64*1024*1024, 0x5a);
+
+  for (size_t threads: {size_t(1), size_t(0)}) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    auto digest = Digest::Blake3(payload, threads);
+
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = finish - start;
+    auto diff = (float)elapsed.count()/1000;
+
+    std::cout << "digest[64MB] blake3[threads=" << threads << "]: " << diff << "sec, " << 64/diff << "MB/s" <<std::endl;
+  }
+}
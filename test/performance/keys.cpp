@@ -0,0 +1,164 @@
+//
+// Random seed and key pair rates
+//
+
+#include "ed25519.hpp"
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <iostream>
+
+using namespace ed25519;
+
+/* the /dev/urandom seed of the reference implementation */
+extern "C" int ed25519_create_seed(unsigned char *seed);
+
+template<typename Function>
+static float seconds_of(int nc, Function &&function) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int k = 0; k < nc; ++k) function();
+  auto finish = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = finish - start;
+  return (float)elapsed.count()/1000;
+}
+
+TEST(TEST, seed_rate){
+  int nc = 200000;
+  size_t total = 0;
+
+  unsigned char seed[size::seed];
+  auto diff = seconds_of(nc, [&] { total += ed25519_create_seed(seed) == 0; });
+  std::cout << "seed /dev/urandom: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "sps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += Seed()[0] + 1; });
+  std::cout << "seed chacha20    : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "sps" << std::endl;
+
+  EXPECT_TRUE(total > 0);
+}
+
+TEST(TEST, pair_random_rate){
+  int nc = 20000;
+
+  for (unsigned threads: {1u, std::max(2u, std::thread::hardware_concurrency())}) {
+    std::vector<std::thread> workers;
+    std::vector<size_t> counts(threads);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&counts, t, nc] {
+          for (int k = 0; k < nc; ++k) counts[t] += keys::Pair::Random().has_value();
+      });
+    }
+    for (auto &worker: workers) worker.join();
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = finish - start;
+    auto diff = (float)elapsed.count()/1000;
+
+    size_t total = 0;
+    for (auto count: counts) total += count;
+    std::cout << "Pair::Random[threads=" << threads << "]: " << total << " time: " << diff << "sec, " << float(total)/diff << "pps" << std::endl;
+
+    EXPECT_EQ(total, threads * size_t(nc));
+  }
+}
+
+TEST(TEST, pair_generate_rate){
+  size_t nc = 20000;
+
+  auto diff = seconds_of(1, [&] {
+      for (size_t k = 0; k < nc; ++k) EXPECT_TRUE(keys::Pair::Random().has_value());
+  });
+  std::cout << "Pair::Random           : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "pps" << std::endl;
+
+  for (size_t threads: {size_t(1), size_t(0)}) {
+    size_t total = 0;
+    diff = seconds_of(1, [&] { total += keys::Pair::Generate(nc, threads).size(); });
+    std::cout << "Pair::Generate[threads=" << threads << "]: " << total << " time: " << diff << "sec, " << float(total)/diff << "pps" << std::endl;
+    EXPECT_EQ(total, nc);
+  }
+}
+
+TEST(TEST, ephemeral_rate){
+  int nc = 20000;
+
+  auto ephemeral = keys::Ephemeral::Random();
+  keys::ExchangeKey base;
+  base[0] = 9;
+
+  size_t total = 0;
+  auto diff = seconds_of(nc, [&] { total += ephemeral->exchange(base)[0]; });
+  std::cout << "X25519 ladder over u=9 : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "kps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += keys::Ephemeral::Random()->get_public_key()[0]; });
+  std::cout << "Ephemeral::Random      : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "kps" << std::endl;
+
+  auto peer = keys::Ephemeral::Random();
+  diff = seconds_of(nc, [&] { total += ephemeral->exchange(peer->get_public_key())[0]; });
+  std::cout << "Ephemeral::exchange    : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  EXPECT_TRUE(total > 0);
+}
+
+TEST(TEST, exchange_rate){
+  int nc = 10000;
+
+  auto pair = keys::Pair::Random();
+  auto peer = keys::Pair::Random()->get_public_key();
+  keys::PreparedPeer prepared(peer);
+
+  size_t total = 0;
+  auto diff = seconds_of(nc, [&] { total += pair->exchange(peer)[0]; });
+  std::cout << "Pair::exchange(Public)      : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  diff = seconds_of(nc, [&] { total += pair->exchange(prepared)[0]; });
+  std::cout << "Pair::exchange(PreparedPeer): " << nc << " time: " << diff << "sec, " << float(nc)/diff << "eps" << std::endl;
+
+  std::vector<keys::Public> peers;
+  for (auto &generated: keys::Pair::Generate(size_t(nc)))
+    peers.push_back(generated.get_public_key());
+
+  diff = seconds_of(1, [&] { for (auto &key: peers) total += keys::PreparedPeer(key).get_exchange_key()[0]; });
+  std::cout << "PreparedPeer(Public)        : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "kps" << std::endl;
+
+  diff = seconds_of(1, [&] { total += keys::PreparedPeer::Prepare(peers).size(); });
+  std::cout << "PreparedPeer::Prepare       : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "kps" << std::endl;
+
+  EXPECT_TRUE(total > 0);
+}
+
+extern "C" void ed25519_add_scalar(unsigned char *public_key, unsigned char *private_key, const unsigned char *scalar);
+
+TEST(TEST, derive_rate){
+  size_t nc = 20000;
+
+  auto parent = keys::Pair::Random()->get_public_key();
+  std::vector<keys::Tweak> tweaks(nc);
+  for (size_t i = 0; i < nc; ++i) {
+    auto seed = Seed();
+    std::copy(seed.begin(), seed.end(), tweaks[i].begin());
+  }
+
+  size_t total = 0;
+  auto diff = seconds_of(1, [&] {
+      for (auto &tweak: tweaks) {
+        std::array<unsigned char, size::public_key> child;
+        std::copy(parent.begin(), parent.end(), child.begin());
+        ed25519_add_scalar(child.data(), nullptr, tweak.data());
+        total += child[0];
+      }
+  });
+  std::cout << "ed25519_add_scalar         : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "kps" << std::endl;
+
+  auto prepared = keys::PreparedParent::Prepare(parent);
+  diff = seconds_of(1, [&] { for (auto &tweak: tweaks) total += prepared->derive(tweak)[0]; });
+  std::cout << "PreparedParent::derive     : " << nc << " time: " << diff << "sec, " << float(nc)/diff << "kps" << std::endl;
+
+  for (size_t threads: {size_t(1), size_t(0)}) {
+    diff = seconds_of(1, [&] { total += prepared->derive(tweaks, threads).size(); });
+    std::cout << "PreparedParent::derive[threads=" << threads << "]: " << nc << " time: " << diff << "sec, " << float(nc)/diff << "kps" << std::endl;
+  }
+
+  EXPECT_TRUE(total > 0);
+}
@@ -8,6 +8,7 @@
 #include <chrono>
 #include <string>
 #include <iostream>
+#include <memory_resource>
 
 using namespace ed25519;
 
@@ -43,3 +44,125 @@ TEST(TEST, siganture_rate){
 
   }
 }
+
+TEST(TEST, validate_rate){
+
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  auto signature = pair->sign(std::string("message"));
+  int nc = 100000;
+  int vc = 0;
+
+  auto rate = [&](const std::string &name, int count, auto &&function) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int k = 0; k < count; ++k) vc += function();
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = finish - start;
+    auto diff = (float)elapsed.count()/1000;
+    std::cout << name << ": " << count << " time: " << diff << "sec, " << float(count)/diff << "vps" << std::endl;
+  };
+
+  rate("validate signature", nc, [&] { return signature->validate(); });
+  rate("validate public key", nc, [&] { return pair->get_public_key().validate(); });
+  rate("validate private key", nc, [&] { return pair->get_private_key().validate(); });
+  rate("validate pair", nc / 10, [&] { return pair->validate(); });
+
+  EXPECT_EQ(vc, 3 * nc + nc / 10);
+}
+
+TEST(TEST, verify_cache_rate){
+
+  // 1000 distinct gossip messages, every one arrives 10 times
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  std::vector<std::string> messages;
+  std::vector<std::unique_ptr<Signature>> signatures;
+  for (int k = 0; k < 1000; ++k) {
+    messages.push_back("gossip message " + std::to_string(k));
+    signatures.push_back(pair->sign(messages.back()));
+  }
+
+  auto rate = [&](const std::string &name) {
+    int vc = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int copy = 0; copy < 10; ++copy)
+      for (size_t k = 0; k < messages.size(); ++k)
+        vc += signatures[k]->verify(messages[k], pair->get_public_key());
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = finish - start;
+    auto diff = (float)elapsed.count()/1000;
+    std::cout << name << ": " << vc << " time: " << diff << "sec, " << float(vc)/diff << "sps" << std::endl;
+    EXPECT_EQ(vc, 10000);
+  };
+
+  rate("verify without cache");
+
+  verify_cache::enable();
+  rate("verify with cache   ");
+  auto stats = verify_cache::stats();
+  std::cout << "hit rate: " << stats.hit_rate() << " of " << stats.hits + stats.misses << std::endl;
+  verify_cache::disable();
+}
+
+TEST(TEST, verifier_rate){
+
+  // mixed traffic: small messages with a few large ones
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  std::vector<std::string> messages;
+  std::vector<std::unique_ptr<Signature>> signatures;
+  for (int k = 0; k < 4000; ++k) {
+    messages.push_back(std::string(k % 50 == 0 ? 1024 * 1024 : 64 + k % 512, static_cast<char>(k)));
+    signatures.push_back(pair->sign(messages.back()));
+  }
+
+  auto report = [&](const std::string &name, size_t vc, std::chrono::high_resolution_clock::time_point start) {
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = finish - start;
+    auto diff = (float)elapsed.count()/1000;
+    std::cout << name << ": " << vc << " time: " << diff << "sec, " << float(vc)/diff << "sps" << std::endl;
+    EXPECT_EQ(vc, messages.size());
+  };
+
+  auto start = std::chrono::high_resolution_clock::now();
+  size_t vc = 0;
+  for (size_t k = 0; k < messages.size(); ++k) vc += signatures[k]->verify(messages[k], pair->get_public_key());
+  report("Signature::verify", vc, start);
+
+  std::atomic<size_t> verified(0);
+  start = std::chrono::high_resolution_clock::now();
+  {
+    Verifier verifier;
+    for (size_t k = 0; k < messages.size(); ++k)
+      verifier.submit(*signatures[k], pair->get_public_key(), messages[k], [&verified](bool ok) { verified += ok; });
+    verifier.wait();
+  }
+  report("Verifier         ", verified.load(), start);
+}
+
+TEST(TEST, memory_resource_rate){
+
+  auto pair = keys::Pair::WithSecret("some secret phrase");
+  std::string message(256, 'm');
+  int nc = 20000;
+
+  auto rate = [&](const std::string &name, auto &&function) {
+    size_t total = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int k = 0; k < nc; ++k) total += function();
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = finish - start;
+    auto diff = (float)elapsed.count()/1000;
+    std::cout << name << ": " << nc << " time: " << diff << "sec, " << float(nc)/diff << "rps" << std::endl;
+    EXPECT_TRUE(total > 0);
+  };
+
+  rate("sign + encode, heap ", [&] {
+      auto signature = pair->sign(message);
+      return signature->encode().size();
+  });
+
+  std::array<unsigned char, 1024> buffer{};
+  rate("sign + encode, arena", [&] {
+      std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+      auto signature = pair->sign(message, &arena);
+      return signature->encode(&arena).size();
+  });
+}